@@ -18,8 +18,8 @@ function CompileMex(varargin)
 %         These files can be debugged in Visual Studio and other IDEs, but
 %         they run slower than the normal files.
 % Files - The name of the mex-file that should be compiled. The mex-files
-%         that can be compiled are 'Hungarian', 'ViterbiTrackLinking',
-%         'SeededWatershed', and 'MergeWatersheds'. A cell array with the
+%         that can be compiled are 'Hungarian', 'SparseHungarian',
+%         'ViterbiTrackLinking', 'SeededWatershed', and 'MergeWatersheds'. A cell array with the
 %         names of multiple mex-files can also be given as input. The
 %         default is to compile all mex-files.
 % GPP44 - Tells the function to use version 4.4 or g++ for compilation of
@@ -34,6 +34,7 @@ addpath(subdirs{1}{:});
 % Names of the mex-files that can be compiled.
 filenames = {...
     'Hungarian'
+    'SparseHungarian'
     'ViterbiTrackLinking'
     'SeededWatershed'
     'MergeWatersheds'};
@@ -50,8 +51,9 @@ end
 for i = 1:length(aFiles)
     if ~any(strcmp(filenames, aFiles{i}))
         error(['%s is not a file that can be compiled. The valid '...
-            'options are ''Hungarian'', ''ViterbiTrackLinking'', '...
-            '''SeededWatershed'', and ''MergeWatersheds''.'], aFiles{i})
+            'options are ''Hungarian'', ''SparseHungarian'', '...
+            '''ViterbiTrackLinking'', ''SeededWatershed'', and '...
+            '''MergeWatersheds''.'], aFiles{i})
     end
 end
 
@@ -73,6 +75,14 @@ else
     debugStr = '';
 end
 
+% ViterbiTrackLinking uses C++11 threads, which require pthreads on Linux
+% and Mac.
+if isunix
+    threadStr = 'CXXFLAGS="$CXXFLAGS -std=c++11 -pthread" LDFLAGS="$LDFLAGS -pthread"';
+else
+    threadStr = '';
+end
+
 % Compile implementation of the Hungarian algorithm.
 if any(strcmp(aFiles, 'Hungarian'))
     cd(fullfile(basePath, 'Tracking', 'Hungarian'))
@@ -81,37 +91,54 @@ if any(strcmp(aFiles, 'Hungarian'))
     fprintf('Done compiling Hungarian.\n')
 end
 
+% Compile sparse implementation of the Hungarian algorithm.
+if any(strcmp(aFiles, 'SparseHungarian'))
+    cd(fullfile(basePath, 'Tracking', 'Hungarian'))
+    compileStr_SparseHungarian = sprintf('mex %s %s SparseHungarian.cpp',...
+        gccStr, debugStr);
+    eval(compileStr_SparseHungarian)
+    fprintf('Done compiling SparseHungarian.\n')
+end
+
 % Compile sparse implementation of the Viterbi-tracking.
 if any(strcmp(aFiles, 'ViterbiTrackLinking'))
     cd(fullfile(basePath, 'Tracking', 'Viterbi'))
-    compileStr_ViterbiTrackLinking = sprintf(['mex -DMATLAB %s %s '...
+    compileStr_ViterbiTrackLinking = sprintf(['mex -DMATLAB %s %s %s '...
         'ViterbiTrackLinking.cpp '...
         'Apoptosis.cpp '...
         'Appearance.cpp '...
+        'Arena.cpp '...
         'Arc.cpp '...
         'ArraySave.cpp '...
         'CellNode.cpp '...
         'CellTrellis.cpp '...
+        'ComponentLinker.cpp '...
         'Count.cpp '...
         'Detection.cpp '...
         'Disappearance.cpp '...
         'Event.cpp '...
         'FreeArc.cpp '...
         'FreeArcNoSwap.cpp '...
+        'Hub.cpp '...
         'IdleState.cpp '...
         'LogStream.cpp '...
         'LogStreamBuffer.cpp '...
         'Migration.cpp '...
         'Mitosis.cpp '...
         'Node.cpp '...
+        'OnlineLinker.cpp '...
         'Persist.cpp '...
         'Preexist.cpp '...
+        'ScoreMatrix.cpp '...
         'State.cpp '...
         'Swap.cpp '...
+        'SwapHub.cpp '...
+        'ThreadPool.cpp '...
+        'TrackLinker.cpp '...
         'Tree.cpp '...
         'Trellis.cpp '...
         'Variable.cpp'],...
-        gccStr, debugStr);
+        gccStr, debugStr, threadStr);
     eval(compileStr_ViterbiTrackLinking)
     fprintf('Done compiling ViterbiTrackLinking.\n')
 end
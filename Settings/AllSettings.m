@@ -1548,6 +1548,155 @@ sett.TrackSingleIdleState = Setting(...
     'tooltip', ['If this is 1, the track linking algorithm can add '...
     'multiple track fragments in the same iteration.']);
 
+sett.TrackNumThreads = Setting(...
+    'name', 'TrackNumThreads',...
+    'default', 1,...
+    'type', 'numeric',...
+    'category', 'tracking',...
+    'level', 'development',...
+    'checkfunction', @IsNonNegativeInteger,...
+    'tooltip', ['The number of threads used by the track linking '...
+    'algorithm to search for the best track modifications. If this is '...
+    '0, one thread per core is used. The tracking results do not depend '...
+    'on the number of threads.']);
+
+sett.TrackWindowedSearch = Setting(...
+    'name', 'TrackWindowedSearch',...
+    'default', 0,...
+    'type', 'numeric',...
+    'category', 'tracking',...
+    'level', 'development',...
+    'checkfunction', @IsBinary,...
+    'tooltip', ['If this is 1, the track linking algorithm only '...
+    'recomputes scores in the window of frames that changed in the '...
+    'previous iteration. This is faster for long sequences, but tracks '...
+    'with equal scores can be chosen differently.']);
+
+sett.TrackBatchSize = Setting(...
+    'name', 'TrackBatchSize',...
+    'default', 1,...
+    'type', 'numeric',...
+    'category', 'tracking',...
+    'level', 'development',...
+    'checkfunction', @IsPositiveInteger,...
+    'tooltip', ['The maximum number of cells that the track linking '...
+    'algorithm can add in each iteration. Values larger than 1 make the '...
+    'tracking faster when there are many cells, but the results can '...
+    'be different from when the cells are added one at a time.']);
+
+sett.TrackLazySwaps = Setting(...
+    'name', 'TrackLazySwaps',...
+    'default', 0,...
+    'type', 'numeric',...
+    'category', 'tracking',...
+    'level', 'development',...
+    'checkfunction', @IsBinary,...
+    'tooltip', ['If this is 1, the track linking algorithm evaluates '...
+    'the possible swaps of track links during the search, instead of '...
+    'creating all of them in advance. This uses less memory and time '...
+    'when there are many possible events, but tracks with equal scores '...
+    'can be chosen differently.']);
+
+sett.TrackOnlineWindow = Setting(...
+    'name', 'TrackOnlineWindow',...
+    'default', 0,...
+    'type', 'numeric',...
+    'category', 'tracking',...
+    'level', 'development',...
+    'checkfunction', @IsNonNegativeInteger,...
+    'tooltip', ['If this is larger than 0, the track linking is done '...
+    'in windows of this many images, starting from the beginning of '...
+    'the image sequence. After a window has been linked, the tracks in '...
+    'all images except the last TrackOnlineHorizon-1 images are fixed. '...
+    'This bounds the memory used by the track linking, but links that '...
+    'would change fixed tracks can not be made.']);
+
+sett.TrackOnlineHorizon = Setting(...
+    'name', 'TrackOnlineHorizon',...
+    'default', 0,...
+    'type', 'numeric',...
+    'category', 'tracking',...
+    'level', 'development',...
+    'checkfunction', @IsNonNegativeInteger,...
+    'visiblefunction', @(x) x.Get('TrackOnlineWindow') > 0,...
+    'tooltip', ['The number of images at the end of each window in '...
+    'online track linking, which are linked again together with the '...
+    'next window. The tracks in the first of these images are fixed, '...
+    'so only the tracks in the other TrackOnlineHorizon-1 images can '...
+    'change. The value must be smaller than TrackOnlineWindow. If it '...
+    'is 0, half of the window is used.']);
+
+sett.TrackDecompose = Setting(...
+    'name', 'TrackDecompose',...
+    'default', 0,...
+    'type', 'numeric',...
+    'category', 'tracking',...
+    'level', 'development',...
+    'checkfunction', @IsBinary,...
+    'tooltip', ['If this is 1, the detections are split into groups '...
+    'that are not connected by any migrations or mitoses, and the groups '...
+    'are linked in parallel on TrackNumThreads threads. The result is '...
+    'usually the same as without the split, but greedy choices that '...
+    'cross groups through swaps of appearing cells can differ. With '...
+    'TrackSingleIdleState, a cell that disappears from one group and '...
+    'appears in another is split into two cells.']);
+
+sett.TrackMinScore = Setting(...
+    'name', 'TrackMinScore',...
+    'default', 0,...
+    'type', 'numeric',...
+    'category', 'tracking',...
+    'level', 'development',...
+    'checkfunction', @IsNonNegative,...
+    'tooltip', ['The score increase that a new cell track must give for it '...
+    'to be added in the track linking. The track linking stops when no '...
+    'track gives a larger increase. Values above 0 save time by skipping '...
+    'tracks that give small improvements.']);
+
+sett.TrackMaxIterations = Setting(...
+    'name', 'TrackMaxIterations',...
+    'default', 0,...
+    'type', 'numeric',...
+    'category', 'tracking',...
+    'level', 'development',...
+    'checkfunction', @IsNonNegativeInteger,...
+    'tooltip', ['The maximum number of iterations in the track linking. '...
+    'If it is 0, there is no limit. Can not be used together with '...
+    'TrackOnlineWindow or TrackDecompose.']);
+
+sett.TrackTimeBudget = Setting(...
+    'name', 'TrackTimeBudget',...
+    'default', 0,...
+    'type', 'numeric',...
+    'category', 'tracking',...
+    'level', 'development',...
+    'checkfunction', @IsNonNegative,...
+    'tooltip', ['The number of seconds after which the track linking '...
+    'stops adding tracks. If it is 0, there is no limit. Can not be used '...
+    'together with TrackOnlineWindow or TrackDecompose.']);
+
+sett.TrackLogVerbosity = Setting(...
+    'name', 'TrackLogVerbosity',...
+    'default', 3,...
+    'type', 'numeric',...
+    'category', 'tracking',...
+    'level', 'development',...
+    'checkfunction', @IsNonNegativeInteger,...
+    'tooltip', ['How much the track linking prints. 0 prints only '...
+    'warnings, 1 prints a summary, 2 prints one line per iteration and 3 '...
+    'prints every executed event.']);
+
+sett.TrackAsyncLog = Setting(...
+    'name', 'TrackAsyncLog',...
+    'default', 0,...
+    'type', 'numeric',...
+    'category', 'tracking',...
+    'level', 'development',...
+    'checkfunction', @IsBinary,...
+    'tooltip', ['If this is 1, the printouts from the track linking are '...
+    'written by a background thread, and printouts to the command window '...
+    'are printed in large batches.']);
+
 sett.TrackBipartiteMatch = Setting(...
     'name', 'TrackBipartiteMatch',...
     'default', 1,...
@@ -1558,6 +1707,17 @@ sett.TrackBipartiteMatch = Setting(...
     'tooltip', ['If this is set to 1, bipartite matching will be used '...
     'to optimize track links when regions are split after tracking.']);
 
+sett.TrackBipartiteNumNeighbours = Setting(...
+    'name', 'TrackBipartiteNumNeighbours',...
+    'default', 10,...
+    'type', 'numeric',...
+    'category', 'tracking',...
+    'level', 'development',...
+    'checkfunction', @IsNonNegativeInteger,...
+    'tooltip', ['The number of neighboring cells that each cell can be '...
+    'matched to in the bipartite matching. If it is 0, there is no limit. '...
+    'The same graph is used with SparseHungarian and with Hungarian.']);
+
 sett.TrackFalsePos = Setting(...
     'name', 'TrackFalsePos',...
     'default', 1,...
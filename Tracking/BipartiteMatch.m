@@ -19,7 +19,8 @@ function oCells = BipartiteMatch(aCells, aImData)
 % oCells - Array of Cell objets where every cell has its own outline.
 %
 % See also:
-% BreakClusters, Hungarian.cpp, BipartiteMatch_correction
+% BreakClusters, Hungarian.cpp, SparseHungarian.cpp,
+% BipartiteMatch_correction
 
 oCells = aCells;
 if isempty(oCells)
@@ -30,9 +31,27 @@ end
 % Score put on edges that are not allowed in the matching.
 INF_SCORE = -1E4;
 
-% Consider all matching options and not just the most likely ones.
+% Score put on edges that are not in the graph, when the dense solver is
+% used. It is lower than the scores of an appearance and a disappearance
+% together, so the edges are never part of the optimal matching.
+MISSING_SCORE = 3 * INF_SCORE;
+
+% The largest number of nodes in a dense frame where the matching of the
+% sparse solver is checked against the dense solver.
+MAX_CHECK_NODES = 100;
+
+useSparse = exist('SparseHungarian', 'file') == 3;
+
+% Both solvers are given the same graph, so the number of neighbors does
+% not depend on which solver is compiled.
 imData = aImData.Clone();
-imData.Set('TrackNumNeighbours', inf)
+numNeighbours = aImData.Get('TrackBipartiteNumNeighbours');
+if numNeighbours == 0
+    % Consider all matching options and not just the most likely ones.
+    imData.Set('TrackNumNeighbours', inf)
+else
+    imData.Set('TrackNumNeighbours', numNeighbours)
+end
 
 % Blobs from segmentation.
 blobSeq = Cells2Blobs(oCells, aImData);
@@ -95,34 +114,64 @@ for t = 2 : length(blobSeq)
     
     % % Compute scores for different matching options.
     
-    scores = INF_SCORE * ones(nMig + nApp + nDis + 2*nMit + min(nMig,20));
-    scores(length(blobs{1})+1:end,length(blobs{2})+1:end) = 0;
+    % Numbers of cells in the two images.
+    n1 = length(blobs{1});
+    n2 = length(blobs{2});
     
-    % Enter migration scores.
+    % Migration scores.
     migrationScores = MigrationScores_generic(blobs, imData);
-    if ~isempty(migrationScores)
-        scores(sub2ind(size(scores), migrationScores(:,2), migrationScores(:,3))) =...
-            max(migrationScores(:,5) - migrationScores(:,4), INF_SCORE/10);
+    if isempty(migrationScores)
+        migrationScores = zeros(0,5);
     end
+    migrate = max(migrationScores(:,5) - migrationScores(:,4), INF_SCORE/10);
     
-    % Enter appearance scores.
+    % Appearance scores.
     appearScores = AppearanceScores(blobs, imData);
+    appear = INF_SCORE * ones(n2,1);
     for i = 1:size(appearScores,1)
-        scores(length(blobs{1})+1:end, appearScores(i,2)) =...
+        appear(appearScores(i,2)) =...
             max(appearScores(i,4) - appearScores(i,3), INF_SCORE/10);
     end
     
-    % Enter disappearance scores.
+    % Disappearance scores.
     blobs{1} = blobs{1}(1:nMig+nDis);  % Dividing cells are not allowed to disappear.
     disappearScores = DisappearanceScores(blobs, imData);
+    disappear = INF_SCORE * ones(n1,1);
     for i = 1:size(disappearScores,1)
-        scores(disappearScores(i,2), length(blobs{2})+1:end) =...
+        disappear(disappearScores(i,2)) =...
             max(disappearScores(i,4) - disappearScores(i,3), INF_SCORE/10);
     end
     
     % % Perform matching.
     
-    match = Hungarian(-scores);
+    % Every cell has its own dummy node, which it is matched to if it
+    % appears or disappears. Cell j in image t has a dummy node in row
+    % n1+j and cell i in image t-1 has a dummy node in column n2+i. The
+    % dummy nodes of two cells are connected if the cells are, so that the
+    % dummy nodes of migrating cells can be matched to each other. This
+    % means that there is always a complete matching.
+    rows = [migrationScores(:,2); n1 + (1:n2)'; (1:n1)'; n1 + migrationScores(:,3)];
+    cols = [migrationScores(:,3); (1:n2)'; n2 + (1:n1)'; n2 + migrationScores(:,2)];
+    values = [migrate; appear; disappear; zeros(size(migrate))];
+    scores = sparse(rows, cols, values, n1 + n2, n1 + n2);
+    if useSparse
+        match = SparseHungarian(rows, cols, -values, n1 + n2);
+        
+        if size(migrationScores,1) == n1 * n2 && n1 + n2 <= MAX_CHECK_NODES
+            % All cells are connected, so the dense solver can check the
+            % matching. The dummy nodes that are matched to each other can
+            % differ, as they do not change the result.
+            denseMatch = DenseMatch(rows, cols, values, n1, n2, MISSING_SCORE);
+            if ~isequal(min(match(:), n2+1), min(denseMatch(:), n2+1))
+                warning('BipartiteMatch:solverMismatch',...
+                    ['SparseHungarian and Hungarian gave different '...
+                    'matchings in frame %d. This can happen if two '...
+                    'matchings have the same score.'], t)
+            end
+        end
+    else
+        match = DenseMatch(rows, cols, values, n1, n2, MISSING_SCORE);
+    end
     
     % % Break cell chains and put them together according to the matching.
     
@@ -157,12 +206,21 @@ for t = 2 : length(blobSeq)
         end
     end
     
-    % Add links for mitosis.
+    % Add links for mitosis. A parent node can be matched to a dummy node
+    % if it cannot be linked to any cell.
     for i = 1:nMit
-        daughter1 = cells2( match(nMig + nDis + 2*i - 1) );
-        daughter2 = cells2( match(nMig + nDis + 2*i) );
-        score1 = scores(nMig + nDis + 2*i - 1, match(nMig + nDis + 2*i - 1));
-        score2 = scores(nMig + nDis + 2*i, match(nMig + nDis + 2*i));
+        match1 = match(nMig + nDis + 2*i - 1);
+        match2 = match(nMig + nDis + 2*i);
+        daughter1 = cells2( match1(match1 <= length(cells2)) );
+        daughter2 = cells2( match2(match2 <= length(cells2)) );
+        score1 = INF_SCORE;
+        score2 = INF_SCORE;
+        if ~isempty(daughter1)
+            score1 = scores(nMig + nDis + 2*i - 1, match1);
+        end
+        if ~isempty(daughter2)
+            score2 = scores(nMig + nDis + 2*i, match2);
+        end
         if score1 > INF_SCORE && score2 > INF_SCORE
             parents(i).AddChild(daughter1);
             parents(i).AddChild(daughter2);
@@ -184,12 +242,37 @@ for t = 2 : length(blobSeq)
     end
     
     % Add appearing cells.
-    for i = 1 : nApp + min(nMig,20)
-        m = match(nMig + nDis + 2*nMit + i);
+    for i = n1 + 1 : length(match)
+        m = match(i);
         if m <= length(cells2)
             appearingCell = cells2(m);
             oCells = [oCells appearingCell]; %#ok<AGROW>
         end
     end
 end
-end
\ No newline at end of file
+end
+
+function oMatch = DenseMatch(aRows, aCols, aValues, aN1, aN2, aMissingScore)
+% Solves the matching problem of BipartiteMatch using the dense solver.
+%
+% All dummy nodes are connected to each other with the score 0, which
+% gives the same optimal matching of the cells as when only the dummy
+% nodes of connected cells are connected.
+%
+% Inputs:
+% aRows - Row indices of the edges in the graph.
+% aCols - Column indices of the edges in the graph.
+% aValues - Scores of the edges in the graph.
+% aN1 - Number of cells in the first image.
+% aN2 - Number of cells in the second image.
+% aMissingScore - Score of edges that are not in the graph.
+%
+% Outputs:
+% oMatch - Column vector with the column matched to each row.
+
+n = aN1 + aN2;
+scores = aMissingScore * ones(n);
+scores(aN1+1:end,aN2+1:end) = 0;
+scores(sub2ind([n n], aRows, aCols)) = aValues;
+oMatch = Hungarian(-scores);
+end
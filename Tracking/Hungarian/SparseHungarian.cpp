@@ -0,0 +1,323 @@
+/* A sparse implementation of the Hungarian algorithm, that can be compiled as
+ * a .mex file for Matlab or as a freestanding program (only for debugging
+ * purposes). Only the arcs that are given as input can be part of the
+ * matching, so the memory usage is linear in the number of arcs instead of
+ * quadratic in the number of nodes, and large problems where every node can
+ * only be matched to a few other nodes can be solved quickly.*/
+
+#define MATLAB // Comment out to compile as free standing program that can be debugged without Matlab.
+
+#include <functional> // greater
+#include <iostream> // printf
+#include <limits> // maximum double value
+#include <queue> // priority_queue
+#include <utility> // pair
+#include <vector>
+
+#ifdef MATLAB
+#define printf mexPrintf // Makes outputs print to Matlab command window.
+#include "mex.h" // matlab types and functions
+#include "matrix.h" // matlab matrices
+#endif
+
+using namespace std;
+
+bool SparseHungarian(int aN, int aNumArcs, const int *aV, const int *aU, const double *aC, int *aMateV){
+	/* Solves the assignment problem (also called weighted bipartite
+	* matching) on a sparse bipartite graph, using shortest augmenting paths
+	* in the way of Jonker and Volgenant. The v-nodes are matched one at a
+	* time. For every v-node, Dijkstra's algorithm is used to find the
+	* augmenting path with the lowest reduced cost, and the dual variables of
+	* the u-nodes are updated so that the reduced costs stay non-negative.
+	* Every augmentation costs O(m*log(m)) in the worst case, where m is the
+	* number of arcs, but usually only a small part of the graph is searched.
+	* On a dense graph, the matching has the same cost as the matching found
+	* by Hungarian.cpp, and it is the same matching unless there are multiple
+	* optimal matchings.
+	*
+	* Inputs:
+	* aN - Number of pairs to be matched.
+	* aNumArcs - Number of arcs in the bipartite graph.
+	* aV - Zero based indices of the v-nodes where the arcs start.
+	* aU - Zero based indices of the u-nodes where the arcs end.
+	* aC - Costs of the arcs.
+	* aMateV - Array where the output will be saved. aMateV[v] will contain
+	* the index of the u-node matched to v in the optimal matching, when
+	* the function is done executing.
+	*
+	* Outputs:
+	* Returns false if the arcs do not allow all nodes to be matched.*/
+
+	const double inf = numeric_limits<double>::infinity();
+
+	int v; // Index of v-nodes.
+	int u; // Index of u-nodes.
+	int a; // Index of arcs.
+
+	// Compressed representation of the arcs, sorted by v-node. The arcs of
+	// v-node v are arcs offsets[v] to offsets[v+1]-1 in arcU and arcC.
+	vector<int> offsets(aN+1, 0);
+	vector<int> arcU(aNumArcs);
+	vector<double> arcC(aNumArcs);
+	for(a=0;a<aNumArcs;a++){
+		offsets[aV[a]+1]++;
+	}
+	for(v=0;v<aN;v++){
+		offsets[v+1] += offsets[v];
+	}
+	vector<int> next(offsets.begin(), offsets.end()-1); // Next free position for the arcs of each v-node.
+	for(a=0;a<aNumArcs;a++){
+		arcU[next[aV[a]]] = aU[a];
+		arcC[next[aV[a]]] = aC[a];
+		next[aV[a]]++;
+	}
+
+	vector<int> mateU(aN, -1); // v-nodes matched to u-nodes.
+	vector<double> mateC(aN, 0); // Costs of the arcs that the v-nodes are matched through.
+	vector<double> beta(aN, 0); // Dual variables associated with u.
+	vector<double> dist(aN, inf); // Reduced costs of the shortest paths to the u-nodes.
+	vector<int> pred(aN, -1); // Previous v-nodes on the shortest paths to the u-nodes.
+	vector<int> predArc(aN, -1); // Arcs that the shortest paths arrive at the u-nodes through.
+	vector<char> scanned(aN, 0); // True for u-nodes where the shortest path is known.
+	vector<int> reached; // u-nodes that have been reached in the current search.
+	priority_queue<pair<double,int>, vector<pair<double,int> >, greater<pair<double,int> > > heap;
+
+	for(v=0;v<aN;v++){
+		aMateV[v] = -1;
+	}
+
+	for(int s=0;s<aN;s++){ // Match one v-node at a time.
+		int sink = -1; // Unmatched u-node at the end of the augmenting path.
+		double minDist = 0; // Reduced cost of the augmenting path.
+		double base = 0; // Reduced cost of the path to v, minus the dual variable of v.
+
+		v = s;
+		while(true){
+			// Relax the arcs of v. The reduced cost of an arc is its cost
+			// minus the dual variables of its end points, and the dual
+			// variable of a matched v-node makes its matching arc tight.
+			for(a=offsets[v];a<offsets[v+1];a++){
+				u = arcU[a];
+				double d = base + arcC[a] - beta[u];
+				if(!scanned[u] && d < dist[u]){
+					if(dist[u] == inf){
+						reached.push_back(u);
+					}
+					dist[u] = d;
+					pred[u] = v;
+					predArc[u] = a;
+					heap.push(make_pair(d, u));
+				}
+			}
+
+			// Find the closest u-node that has not been scanned. Heap
+			// elements with outdated distances are skipped.
+			u = -1;
+			while(!heap.empty()){
+				pair<double,int> top = heap.top();
+				heap.pop();
+				if(!scanned[top.second] && top.first == dist[top.second]){
+					u = top.second;
+					break;
+				}
+			}
+			if(u == -1){ // There is no augmenting path.
+				return false;
+			}
+			scanned[u] = 1;
+
+			if(mateU[u] == -1){ // We have found the end of an augmenting path.
+				sink = u;
+				minDist = dist[u];
+				break;
+			}
+
+			// Continue the search from the v-node that u is matched to.
+			v = mateU[u];
+			base = dist[u] - (mateC[v] - beta[u]);
+		}
+
+		// Update the dual variables of the scanned u-nodes.
+		for(int i=0;i<(int)reached.size();i++){
+			u = reached[i];
+			if(scanned[u]){
+				beta[u] += dist[u] - minDist;
+			}
+		}
+
+		// Augment the matching along the path.
+		u = sink;
+		while(true){
+			v = pred[u];
+			int prevU = aMateV[v];
+			aMateV[v] = u;
+			mateU[u] = v;
+			mateC[v] = arcC[predArc[u]];
+			if(v == s)
+				break;
+			u = prevU;
+		}
+
+		// Reset the search variables of the u-nodes that were reached.
+		for(int i=0;i<(int)reached.size();i++){
+			u = reached[i];
+			dist[u] = inf;
+			scanned[u] = 0;
+		}
+		reached.clear();
+		heap = priority_queue<pair<double,int>, vector<pair<double,int> >, greater<pair<double,int> > >();
+	}
+	return true;
+}
+
+#ifndef MATLAB
+int main(){
+	/* MAIN is used to test the implementation on the problem given in
+	* Example 11.1 in "Combinatorial optimization Algorithms and complexity"
+	* by Papadimitriou and Steiglitz, with the cost matrix given as a list
+	* of arcs. This will be the main function in a normal C++ compilation and
+	* will run without a call from Matlab.*/
+
+	const int n = 5; // Number of pairs to match.
+	double cost = 0; // Total cost of matching.
+	int v, u; // Nodes in bipartite graph.
+	int mateV[n]; // Nodes matched to v-nodes in optimal matching.
+	int V[n*n]; // Start nodes of the arcs.
+	int U[n*n]; // End nodes of the arcs.
+
+	double c[n*n] = {
+		7, 9, 3, 7, 8,
+		2, 6, 8, 9, 4,
+		1, 9, 3, 4, 7,
+		9, 5, 1, 2, 4,
+		4, 5, 8, 2, 8}; // Edge costs.
+
+	for(u=0;u<n;u++){
+		for(v=0;v<n;v++){
+			V[v+u*n] = v;
+			U[v+u*n] = u;
+		}
+	}
+
+	if(!SparseHungarian(n, n*n, V, U, c, mateV)){ // Find cheapest matching.
+		printf("SparseHungarian was unable to find a matching.\n");
+		return 1;
+	}
+
+	// Print cheapest matching.
+	printf("Matched edges:\n");
+	for(v=0;v<n;v++){
+		printf("v%d - u%d : %.2f\n", v+1, mateV[v]+1, c[v+mateV[v]*n]);
+		cost += c[v+mateV[v]*n];
+	}
+	printf("Total cost = %.2f\n", cost);
+	cin.get();
+}
+#endif
+
+#ifdef MATLAB
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]){
+	/* MEXFUNCTION interfaces with matlab.
+	*
+	* Inputs:
+	* int nlhs - Number of outputs.
+	* mxarray *plhs[0] - u-nodes matched to the list of v-nodes.
+	* int nrhs - Number of inputs.
+	* mxarray *prhs[0] - v-nodes where the arcs start (row indices).
+	* mxarray *prhs[1] - u-nodes where the arcs end (column indices).
+	* mxarray *prhs[2] - Arc costs.
+	* mxarray *prhs[3] - Number of node pairs to be matched (optional). The
+	* default is the largest node index.
+	*
+	* The function is called as match = SparseHungarian(rows, cols, costs),
+	* and gives the same output as match = Hungarian(full(sparse(rows, cols,
+	* costs))), except that only the given arcs can be used in the matching.
+	* If the arcs do not allow all nodes to be matched, an error with the
+	* identifier SparseHungarian:noMatching is raised.
+	*/
+
+	int n; // Number of node pairs to be matched.
+	int m; // Number of arcs.
+	int a; // Arc index.
+	int v; // v-node index.
+	int *V; // Start nodes of the arcs.
+	int *U; // End nodes of the arcs.
+	int *mateV; // u-nodes matched to the v-nodes.
+	double *dMateV; // u-nodes matched to the v-nodes. (Double array for output to Matlab.)
+	double *dV; // Start nodes of the arcs. (Double array from Matlab.)
+	double *dU; // End nodes of the arcs. (Double array from Matlab.)
+	double *c; // Arc costs.
+	bool found; // True if a matching was found.
+
+	// Check the number of input and output arguments.
+	if(nrhs < 3 || nrhs > 4){
+		mexErrMsgTxt("SparseHungarian must be called with 3 or 4 input arguments.");}
+	if(nlhs != 1){
+		mexErrMsgTxt("SparseHungarian must be called with 1 output argument.");}
+	for(int i=0;i<nrhs;i++){
+		if(!mxIsDouble(prhs[i]) || mxIsComplex(prhs[i]) || mxIsSparse(prhs[i])){
+			mexErrMsgTxt("The inputs to SparseHungarian must be real, full, double arrays.");}
+	}
+
+	// Input
+	m = (int) mxGetNumberOfElements(prhs[0]);
+	if((int) mxGetNumberOfElements(prhs[1]) != m || (int) mxGetNumberOfElements(prhs[2]) != m){
+		mexErrMsgTxt("The row indices, the column indices and the costs must have the same number of elements.");}
+	dV = mxGetPr(prhs[0]);
+	dU = mxGetPr(prhs[1]);
+	c = mxGetPr(prhs[2]);
+
+	n = 0;
+	for(a=0;a<m;a++){
+		if(dV[a] > n)
+			n = (int) dV[a];
+		if(dU[a] > n)
+			n = (int) dU[a];
+	}
+	if(nrhs == 4){
+		if(mxGetNumberOfElements(prhs[3]) != 1 || mxGetScalar(prhs[3]) < n){
+			mexErrMsgTxt("The number of node pairs must be a scalar which is at least as large as the node indices.");}
+		n = (int) mxGetScalar(prhs[3]);
+	}
+
+	// Memory allocation.
+	V = new int[m];
+	U = new int[m];
+	mateV = new int[n];
+
+	for(a=0;a<m;a++){
+		if(dV[a] < 1 || dU[a] < 1 || dV[a] != (int) dV[a] || dU[a] != (int) dU[a]){
+			delete[] V;
+			delete[] U;
+			delete[] mateV;
+			mexErrMsgTxt("The row and column indices must be positive integers.");
+		}
+		if(c[a] != c[a] || c[a] == numeric_limits<double>::infinity() || c[a] == -numeric_limits<double>::infinity()){
+			delete[] V;
+			delete[] U;
+			delete[] mateV;
+			mexErrMsgTxt("The arc costs must be finite.");
+		}
+		V[a] = (int) dV[a] - 1;
+		U[a] = (int) dU[a] - 1;
+	}
+
+	found = SparseHungarian(n, m, V, U, c, mateV);
+
+	// Output
+	plhs[0] = mxCreateDoubleMatrix(n, 1, mxREAL);
+	dMateV = mxGetPr(plhs[0]);
+
+	// Transfer results to matlab output.
+	for(v=0;v<n;v++)
+		dMateV[v] = (double) mateV[v] + 1;
+
+	// Turn memory back.
+	delete[] V;
+	delete[] U;
+	delete[] mateV;
+
+	if(!found){
+		mexErrMsgIdAndTxt("SparseHungarian:noMatching", "SparseHungarian unable to find matching.");}
+}
+#endif
@@ -36,6 +36,14 @@ function oCells = Track(aImData, varargin)
 %                     images, using the specified number of cores. This
 %                     parameter should be set to 1 if the function is
 %                     called from a parfor-loop. The default is 1.
+% InitialLinks - Cell array with the three outputs cellMat, divMat and
+%                deathMat of ViterbiTrackLinking from a previous run on the
+%                same detections. The track linking starts from these
+%                tracks instead of from an empty set of tracks, which is
+%                faster when the scores have only changed a little. The
+%                default is an empty cell array, which means that the
+%                track linking starts from scratch. A previous result can
+%                not be used together with online track linking.
 %
 % Outputs:
 % oCells - Array of Cell objects that contain information about the
@@ -88,13 +96,19 @@ function oCells = Track(aImData, varargin)
 % ManualCorrectionPlayer
 
 % Parse property/value inputs.
-[aCreateOutputFiles, aSegmentationCores] = GetArgs(...
-    {'CreateOutputFiles', 'SegmentationCores'},...
-    {true, 1},...
+[aCreateOutputFiles, aSegmentationCores, aInitialLinks] = GetArgs(...
+    {'CreateOutputFiles', 'SegmentationCores', 'InitialLinks'},...
+    {true, 1, {}},...
     true, varargin);
 
 fprintf('Tracking cells in %s\n', aImData.seqPath)
 
+% ViterbiTrackLinking takes empty matrices when there is no previous
+% tracking result.
+if isempty(aInitialLinks)
+    aInitialLinks = {[], [], []};
+end
+
 % Features used to compute linking scores (classify of cell events).
 necessaryFeatures = NecessaryFeatures(aImData);
 
@@ -187,7 +201,20 @@ end
     aImData.Get('TrackSingleIdleState'),...
     aImData.Get('TrackMaxMigScore'),...
     iterationFolder,...
-    trackLogFile);
+    trackLogFile,...
+    aImData.Get('TrackNumThreads'),...
+    aImData.Get('TrackWindowedSearch'),...
+    aImData.Get('TrackBatchSize'),...
+    aImData.Get('TrackLazySwaps'),...
+    aInitialLinks{:},...
+    aImData.Get('TrackOnlineWindow'),...
+    aImData.Get('TrackOnlineHorizon'),...
+    aImData.Get('TrackDecompose'),...
+    aImData.Get('TrackMinScore'),...
+    aImData.Get('TrackMaxIterations'),...
+    aImData.Get('TrackTimeBudget'),...
+    aImData.Get('TrackLogVerbosity'),...
+    aImData.Get('TrackAsyncLog'));
 
 % Create Cell objects for tracks created by ViterbiTrackLinking.
 trueCells = Matrix2Cell(cellMat, divMat, deathMat, blobSeq, aImData);
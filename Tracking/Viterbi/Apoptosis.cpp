@@ -29,7 +29,7 @@ void Apoptosis::Execute(Tree *aTree, vector<CellNode*> *aEndCellNodes, bool aPri
 void Apoptosis::Execute(Tree *aTree, vector<CellNode*> *aEndCellNodes, CellNode *aCell) {
 
 	CellNode *activeCell = aTree->GetActiveCell();
-	activeCell->AddLink(this, aCell);
+	activeCell->AddLink(aTree, this, aCell);
 	aTree->SetActiveCell(NULL);  // Ends the cell track.
 	
 	aEndCellNodes->push_back(aCell);
@@ -37,5 +37,8 @@ class Apoptosis : public Event {
 
 		// Returns the score associated with adding the apoptosis event to a tree.
 		virtual double GetScore() const;
+
+		// The score only depends on the apoptosis counter.
+		virtual bool HasLocalScore() const { return true; }
 };
 #endif
\ No newline at end of file
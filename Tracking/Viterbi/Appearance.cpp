@@ -36,7 +36,7 @@ void Appearance::Execute(Tree *aTree, vector<CellNode*> *aEndCellNodes, CellNode
 	}
 	CellNode *activeCell = aTree->GetActiveCell();
 	assert(mStartState = activeCell->GetState());
-	activeCell->AddLink(this, aCell);
+	activeCell->AddLink(aTree, this, aCell);
 
 	aEndCellNodes->push_back(aCell);
 }
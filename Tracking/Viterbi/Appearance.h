@@ -40,5 +40,8 @@ public:
 
 	// Score associated with adding the appearance event to a tree.
 	virtual double GetScore() const;
+
+	// The score only depends on the appearance counter and the cell count of the end Detection.
+	virtual bool HasLocalScore() const { return true; }
 };
 #endif
\ No newline at end of file
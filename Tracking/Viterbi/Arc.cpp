@@ -1,14 +1,30 @@
 #include "Arc.h"
+#include <cstddef>  // To get NULL.
 #include "Node.h"
 
-Arc::Arc(Node *aStart, Node *aEnd) {
+// The positions are set by the nodes.
+Arc::Arc(Node *aStart, Node *aEnd) : mStartPosition(-1), mEndPosition(-1) {
 		mStart = aStart;
 		mEnd = aEnd;
 		mStart->AddForwardArc(this);
 		mEnd->AddBackwardArc(this);
 }
 
+Arc::Arc(Node *aStart, Node *aEnd, bool aAddToNodes) : mStartPosition(-1), mEndPosition(-1) {
+		mStart = aStart;
+		mEnd = aEnd;
+		if (aAddToNodes) {
+			mStart->AddForwardArc(this);
+			mEnd->AddBackwardArc(this);
+		}
+}
+
+// Arcs that are not in the arc lists of the nodes are not removed from them.
 Arc::~Arc() {
-	mStart->RemoveForwardArc(this);
-	mEnd->RemoveBackwardArc(this);
+	if (mStart != NULL) {
+		mStart->RemoveForwardArc(this);
+	}
+	if (mEnd != NULL) {
+		mEnd->RemoveBackwardArc(this);
+	}
 }
\ No newline at end of file
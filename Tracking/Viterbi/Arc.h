@@ -1,17 +1,28 @@
 #ifndef ARC
 #define ARC
 
+#include <cstddef>  // To get size_t.
+#include "Arena.h"
+
 class Node;
 
 // A directed arc, with a score, between two nodes in a trellis. The class is virtual, and requires
 // that the function GetScore is implemented by a sub-class.
 class Arc {
+	// Node stores the positions of the arc in the arc lists of the nodes.
+	friend class Node;
+
 public:
 	// Adds an arc between the nodes aStart and aEnd
 	// The constructor also adds the new arc as a forward arc from aStart and
 	// as a backward arc from aEnd.
 	Arc(Node* aStart, Node* aEnd);
 
+	// Creates an arc between the nodes aStart and aEnd, which is only added to the arc lists of the nodes
+	// if aAddToNodes is true. Arcs that are not in the arc lists are not seen by the Trellis, and are used to
+	// represent paths through Hubs. The nodes can be NULL if the arc is not added to the arc lists.
+	Arc(Node* aStart, Node* aEnd, bool aAddToNodes);
+
 	// Removes the arc from the arc lists of aStart and aEnd. Nodes delete all of their arcs when they are
 	// deleted, but arcs never delete nodes.
 	virtual ~Arc();
@@ -19,12 +30,27 @@ public:
 	// Should return the score associated with traversing the arc.
 	virtual double GetScore() const = 0;
 
+	// Returns true if the score of the arc can only change when the end node reports a change
+	// through Node::SetChanged. The Trellis then reuses the cached score of the arc between
+	// sweeps. Arcs with scores that depend on other parts of the graph must return false.
+	virtual bool HasLocalScore() const { return false; }
+
+	// Returns true if the destructor frees memory that was not taken from the arena of the arc.
+	// Other arcs in an arena do not have to be deleted before the arena is destroyed.
+	virtual bool OwnsHeapMemory() const { return false; }
+
 	Node *GetStartNode() { return mStart; }
 
 	Node *GetEndNode() { return mEnd; }
 
+	// Arcs are allocated from the current Arena.
+	static void *operator new(size_t aSize) { return Arena::Allocate(aSize); }
+	static void operator delete(void *aPointer, size_t aSize) { Arena::Free(aPointer, aSize); }
+
 private:
 	Node* mStart;	// Node at the beginning of the arc.
 	Node* mEnd;		// Node at the end of the arc.
+	int mStartPosition;	// Position of the arc in the forward arc list of mStart.
+	int mEndPosition;	// Position of the arc in the backward arc list of mEnd.
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include "Arena.h"
+#include <cstddef>  // To get NULL.
+#include <new>
+#include <vector>
+
+using namespace std;
+
+// All chunks are multiples of this size, which is enough for the members of the arena objects.
+static const size_t alignment = 8;
+
+// Objects larger than this are allocated from the heap.
+static const size_t maxChunkSize = 512;
+
+// The header stores the Arena that the object was allocated from, or NULL if it was allocated from the heap.
+static const size_t headerSize = alignment;
+
+// The current arena of each thread.
+static thread_local Arena *currentArena = NULL;
+
+Arena::Arena()
+	: mBlockSize(1 << 20), mNext(NULL), mEnd(NULL), mFreeLists(maxChunkSize / alignment + 1, NULL) {
+}
+
+Arena::~Arena() {
+	for (int i=0; i<(int)mBlocks.size(); i++) {
+		::operator delete(mBlocks[i]);
+	}
+}
+
+void *Arena::Allocate(size_t aSize) {
+	size_t size = (aSize + headerSize + alignment - 1) / alignment * alignment;
+	Arena *arena = currentArena;
+	if (size > maxChunkSize) {
+		arena = NULL;
+	}
+
+	char *chunk = NULL;
+	if (arena != NULL) {
+		chunk = (char*) arena->AllocateChunk(size);
+	} else {
+		chunk = (char*) ::operator new(size);
+	}
+	*((Arena**) chunk) = arena;
+	return chunk + headerSize;
+}
+
+void Arena::Free(void *aPointer, size_t aSize) {
+	if (aPointer == NULL) {
+		return;
+	}
+	char *chunk = (char*) aPointer - headerSize;
+	Arena *arena = *((Arena**) chunk);
+	if (arena != NULL) {
+		arena->FreeChunk(chunk, (aSize + headerSize + alignment - 1) / alignment * alignment);
+	} else {
+		::operator delete(chunk);
+	}
+}
+
+size_t Arena::GetAllocatedSize(size_t aSize) {
+	return (aSize + headerSize + alignment - 1) / alignment * alignment;
+}
+
+bool Arena::IsInArena(const void *aPointer) {
+	return *((Arena* const*) ((const char*) aPointer - headerSize)) != NULL;
+}
+
+Arena *Arena::GetCurrent() {
+	return currentArena;
+}
+
+// Freed chunks of the right size are reused first. The free list is linked through the first
+// bytes of the freed chunks.
+void *Arena::AllocateChunk(size_t aSize) {
+	void *&freeList = mFreeLists[aSize / alignment];
+	if (freeList != NULL) {
+		void *chunk = freeList;
+		freeList = *((void**) chunk);
+		return chunk;
+	}
+
+	if (mNext == NULL || (size_t) (mEnd - mNext) < aSize) {
+		// The rest of the last block is wasted, but that is at most maxChunkSize bytes.
+		mBlocks.push_back((char*) ::operator new(mBlockSize));
+		mNext = mBlocks.back();
+		mEnd = mNext + mBlockSize;
+	}
+	void *chunk = mNext;
+	mNext += aSize;
+	return chunk;
+}
+
+void Arena::FreeChunk(void *aChunk, size_t aSize) {
+	void *&freeList = mFreeLists[aSize / alignment];
+	*((void**) aChunk) = freeList;
+	freeList = aChunk;
+}
+
+ArenaScope::ArenaScope(Arena *aArena) {
+	mPrevious = currentArena;
+	currentArena = aArena;
+}
+
+ArenaScope::~ArenaScope() {
+	currentArena = mPrevious;
+}
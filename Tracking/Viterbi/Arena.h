@@ -0,0 +1,72 @@
+#ifndef ARENA
+#define ARENA
+
+#include <cstddef>  // To get size_t.
+#include <vector>
+
+using namespace std;
+
+// Memory pool for the small objects that the tracking algorithm creates and deletes all the time,
+// such as CellNodes and Events. The memory is taken from large blocks and freed objects are put in
+// free lists, one for each object size, from which new objects of the same size are allocated.
+// All blocks are released when the Arena is destroyed, so the objects do not have to be deleted
+// individually before that, unless their destructors do something more than freeing memory.
+//
+// Classes that want to use arenas define operator new and operator delete, which call Allocate and
+// Free. Allocate takes memory from the current arena of the calling thread, which is set using an
+// ArenaScope. If there is no current arena, the memory is taken from the global heap. The arena that
+// allocated an object is stored in front of the object, so that it can be freed from any scope.
+// An Arena must only be used by one thread at a time.
+class Arena {
+public:
+	Arena();
+
+	// Releases all memory blocks. All objects in the arena must be destroyed before this.
+	~Arena();
+
+	// Allocates aSize bytes from the current arena, or from the heap if there is no current arena.
+	static void *Allocate(size_t aSize);
+
+	// Frees memory returned by Allocate. aSize must be the size that was given to Allocate.
+	static void Free(void *aPointer, size_t aSize);
+
+	// Returns the number of bytes that Allocate uses for an object of aSize bytes, including the header.
+	static size_t GetAllocatedSize(size_t aSize);
+
+	// Returns true if aPointer, which must have been returned by Allocate, points into an arena and
+	// not to memory from the heap.
+	static bool IsInArena(const void *aPointer);
+
+	// Returns the current arena of the calling thread, or NULL if there is none.
+	static Arena *GetCurrent();
+
+	// Returns the number of bytes that the arena has reserved from the heap.
+	size_t GetNumBytes() const { return mBlocks.size() * mBlockSize; }
+
+private:
+	friend class ArenaScope;
+
+	size_t mBlockSize;				// The number of bytes in each block.
+	vector<char*> mBlocks;			// Memory blocks that the objects are allocated from.
+	char *mNext;					// The first unused byte in the last block.
+	char *mEnd;						// The end of the last block.
+	vector<void*> mFreeLists;		// Linked lists of freed memory, one for every multiple of the alignment.
+
+	// Allocates aSize bytes, where aSize is a multiple of the alignment, from the arena.
+	void *AllocateChunk(size_t aSize);
+
+	// Puts memory returned by AllocateChunk into the free list for objects of size aSize.
+	void FreeChunk(void *aChunk, size_t aSize);
+};
+
+// Makes an Arena the current arena of the calling thread, as long as the object exists. The previous
+// current arena is restored when the object is destroyed.
+class ArenaScope {
+public:
+	explicit ArenaScope(Arena *aArena);
+	~ArenaScope();
+
+private:
+	Arena *mPrevious;	// The current arena before the object was created.
+};
+#endif
@@ -1,6 +1,17 @@
 #include "ArraySave.h"
+#include <algorithm>
 #include <cstddef>  // To get NULL.
 #include <fstream>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 
@@ -23,45 +34,98 @@ using namespace std;
 //	return;
 //}
 
+// Reverses the byte order of each of the aNumElements elements of size aSize in aData.
+static void SwapBytes(char *aData, size_t aNumElements, size_t aSize) {
+	for (size_t i=0; i<aNumElements; i++) {
+		reverse(aData + i*aSize, aData + (i+1)*aSize);
+	}
+}
+
 //Save a 2D int matrix to a binary file
 void ArraySave::IntMatrixSave(int am, int an, int **aMat, const char *aName){
-	int i, j;
-	int nDim = 2;
-
-	ofstream file(aName, ios::out|ios::binary);
-
-	file.write((char *) &nDim, sizeof(int));
-	file.write((char *) &am, sizeof(int));
-	file.write((char *) &an, sizeof(int));
-	for(j=0;j<an;j++){
-		for(i=0;i<am;i++){
-			file.write((char *) (aMat[i]+j), sizeof(int));
+	vector<int> elements(am*an);
+	for(int j=0;j<an;j++){
+		for(int i=0;i<am;i++){
+			elements[j*am+i] = aMat[i][j];
 		}
 	}
-	file.close();
-	return;
+	int dims[2] = {am, an};
+	Save<int>(2, dims, elements.empty() ? NULL : &elements[0], aName);
 }
 
 //Save a 3D int matrix to a binary file
 void ArraySave::IntMatrixSave3(int am, int an, int ao, int ***aMat, const char *aName){
-	int i, j, k;
-	int nDim = 3;
-
-	ofstream file(aName, ios::out|ios::binary);
-
-	file.write((char *) &nDim, sizeof(int));
-	file.write((char *) &am, sizeof(int));
-	file.write((char *) &an, sizeof(int));
-	file.write((char *) &ao, sizeof(int));
-	for(k=0;k<ao;k++){
-		for(j=0;j<an;j++){
-			for(i=0;i<am;i++){
-				file.write((char *) (aMat[i][j]+k), sizeof(int));
+	vector<int> elements(am*an*ao);
+	for(int k=0;k<ao;k++){
+		for(int j=0;j<an;j++){
+			for(int i=0;i<am;i++){
+				elements[(k*an+j)*am+i] = aMat[i][j][k];
 			}
 		}
 	}
-	file.close();
-	return;
+	int dims[3] = {am, an, ao};
+	Save<int>(3, dims, elements.empty() ? NULL : &elements[0], aName);
+}
+
+void ArraySave::WriteHeader(ofstream &aFile, int aNumDims, const int *aDims) {
+	vector<int> header(3 + aNumDims + (aNumDims+1) % 2, 0);  // Even length gives 8-byte alignment.
+	header[0] = FILE_MAGIC;
+	header[1] = FILE_VERSION;
+	header[2] = aNumDims;
+	copy(aDims, aDims + aNumDims, header.begin() + 3);
+	aFile.write((char *) &header[0], header.size()*sizeof(int));
+}
+
+bool ArraySave::ReadHeader(istream &aFile, vector<int> &aDims, size_t *aDataOffset, bool *aSwap) {
+	aDims.clear();
+	*aSwap = false;
+
+	int first = 0;
+	aFile.read((char *) &first, sizeof(int));
+	if (!aFile) {
+		return false;
+	}
+
+	int swappedMagic = FILE_MAGIC;
+	SwapBytes((char *) &swappedMagic, 1, sizeof(int));
+
+	int nDims = first;
+	bool versioned = (first == FILE_MAGIC || first == swappedMagic);
+	if (versioned) {
+		*aSwap = (first == swappedMagic);
+		int values[2];  // Version and number of dimensions.
+		aFile.read((char *) values, 2*sizeof(int));
+		if (!aFile) {
+			return false;
+		}
+		if (*aSwap) {
+			SwapBytes((char *) values, 2, sizeof(int));
+		}
+		if (values[0] > FILE_VERSION) {
+			return false;
+		}
+		nDims = values[1];
+	}
+	if (nDims < 1) {
+		return false;
+	}
+
+	aDims.resize(nDims);
+	aFile.read((char *) &aDims[0], nDims*sizeof(int));
+	if (!aFile) {
+		aDims.clear();
+		return false;
+	}
+	if (*aSwap) {
+		SwapBytes((char *) &aDims[0], nDims, sizeof(int));
+	}
+
+	if (versioned) {
+		*aDataOffset = (3 + nDims + (nDims+1) % 2) * sizeof(int);
+	} else {
+		*aDataOffset = (1 + nDims) * sizeof(int);
+	}
+	return true;
 }
 
 double *ArraySave::ReadDouble(string aName, int *aLength) {
@@ -76,15 +140,20 @@ double *ArraySave::ReadDouble(string aName, int *aLength) {
 		return retPtr;
 	}
 
-	int byteLength = (int) file.tellg();
+	streamoff byteLength = file.tellg();
 	file.seekg(0, ios::beg);
 	
-	// Read how many dimensions the array has.
-	int nDims;
-	file.read((char *) &nDims, sizeof(int));
+	// Read the header.
+	vector<int> dims;
+	size_t dataOffset = 0;
+	bool swap = false;
+	if (!ReadHeader(file, dims, &dataOffset, &swap) || byteLength < (streamoff) dataOffset) {
+		*aLength = 0;
+		return retPtr;
+	}
 	
 	// Determine the number of doubles that will be returned.
-	int retLength = (byteLength - (1 + nDims)*sizeof(int))/sizeof(double);
+	int retLength = (int) ((byteLength - dataOffset)/sizeof(double));
 	*aLength = retLength;
 	if (retLength == 0) {  // [] was saved in Matlab.
 		return retPtr;
@@ -92,9 +161,209 @@ double *ArraySave::ReadDouble(string aName, int *aLength) {
 
 	// Create the double array.
 	retPtr = new double[retLength];
-	file.seekg((1 + nDims)*sizeof(int), ios::beg);
+	file.seekg(dataOffset, ios::beg);
 	file.read((char *) retPtr, retLength*sizeof(double));
+	if (swap) {
+		SwapBytes((char *) retPtr, retLength, sizeof(double));
+	}
 	
 	file.close();
 	return retPtr;
-}
\ No newline at end of file
+}
+
+vector<int> ArraySave::ReadDims(string aName) {
+	vector<int> dims;
+
+	ifstream file(aName.c_str(), ios::in|ios::binary);
+	if (!file.is_open()) {
+		return dims;
+	}
+
+	size_t dataOffset = 0;
+	bool swap = false;
+	ReadHeader(file, dims, &dataOffset, &swap);
+
+	file.close();
+	return dims;
+}
+
+void ArraySave::AppendChanges(string aName, int aIteration, int aRecordLength,
+	const vector<double> &aRecords, const vector<double> &aPrevious) {
+
+	int numRecords = (int) aRecords.size() / aRecordLength;
+	int numPrevious = (int) aPrevious.size() / aRecordLength;
+
+	// Find the records that have been added or changed.
+	vector<int> changed;
+	for (int r=0; r<numRecords; r++) {
+		if (r >= numPrevious || !equal(aRecords.begin() + r*aRecordLength,
+			aRecords.begin() + (r+1)*aRecordLength, aPrevious.begin() + r*aRecordLength)) {
+			changed.push_back(r);
+		}
+	}
+
+	vector<double> changedRecords;
+	for (int i=0; i<(int)changed.size(); i++) {
+		changedRecords.insert(changedRecords.end(), aRecords.begin() + changed[i]*aRecordLength,
+			aRecords.begin() + (changed[i]+1)*aRecordLength);
+	}
+	AppendRecords(aName, aIteration, aRecordLength, numRecords, changed, changedRecords);
+}
+
+void ArraySave::AppendRecords(string aName, int aIteration, int aRecordLength,
+	int aNumRecords, const vector<int> &aChanged, const vector<double> &aChangedRecords) {
+
+	ofstream file(aName.c_str(), ios::out|ios::binary|ios::app);
+	file.seekp(0, ios::end);
+	if (file.tellp() == streampos(0)) {
+		file.write((char *) &aRecordLength, sizeof(int));
+	}
+
+	int numChanged = (int) aChanged.size();
+	file.write((char *) &aIteration, sizeof(int));
+	file.write((char *) &aNumRecords, sizeof(int));
+	file.write((char *) &numChanged, sizeof(int));
+	for (int i=0; i<numChanged; i++) {
+		file.write((char *) &aChanged[i], sizeof(int));
+		file.write((char *) &aChangedRecords[i*aRecordLength], aRecordLength*sizeof(double));
+	}
+
+	file.close();
+}
+
+int ArraySave::ReadChanges(string aName, int aIteration, int *aRecordLength,
+	vector<double> &aRecords) {
+
+	aRecords.clear();
+	*aRecordLength = 0;
+
+	ifstream file(aName.c_str(), ios::in|ios::binary);
+	if (!file.is_open()) {
+		return -1;
+	}
+
+	int recordLength = 0;
+	file.read((char *) &recordLength, sizeof(int));
+	if (!file || recordLength < 1) {
+		return -1;
+	}
+	*aRecordLength = recordLength;
+
+	int lastIteration = -1;
+	while (true) {
+		int header[3];  // Iteration, number of records and number of changed records.
+		file.read((char *) header, 3*sizeof(int));
+		if (!file || (aIteration >= 0 && header[0] > aIteration)) {
+			break;
+		}
+
+		// Read the whole entry before it is applied, so that an entry which was not completely
+		// written does not change the records.
+		vector<int> indices(header[2]);
+		vector<double> changes(header[2]*recordLength);
+		for (int i=0; i<header[2]; i++) {
+			file.read((char *) &indices[i], sizeof(int));
+			file.read((char *) &changes[i*recordLength], recordLength*sizeof(double));
+		}
+		if (!file) {
+			break;
+		}
+
+		aRecords.resize(header[1]*recordLength);
+		for (int i=0; i<header[2]; i++) {
+			copy(changes.begin() + i*recordLength, changes.begin() + (i+1)*recordLength,
+				aRecords.begin() + indices[i]*recordLength);
+		}
+		lastIteration = header[0];
+	}
+
+	file.close();
+	return lastIteration;
+}
+
+ArrayView::ArrayView(string aName)
+	: mOpen(false), mData(NULL), mLength(0), mMapping(NULL), mMappingSize(0)
+#ifdef _WIN32
+	, mFileHandle(INVALID_HANDLE_VALUE), mMappingHandle(NULL)
+#endif
+	{
+
+	ifstream file(aName.c_str(), ios::in|ios::binary|ios::ate);
+	if (!file.is_open()) {
+		return;
+	}
+	size_t byteLength = (size_t) file.tellg();
+	file.seekg(0, ios::beg);
+
+	size_t dataOffset = 0;
+	bool swap = false;
+	if (!ArraySave::ReadHeader(file, mDims, &dataOffset, &swap) || byteLength < dataOffset) {
+		mDims.clear();
+		return;
+	}
+	mLength = (byteLength - dataOffset) / sizeof(double);
+	mOpen = true;
+	if (mLength == 0) {
+		return;
+	}
+
+	// Read the elements into a buffer if they can not be used directly from the mapped file.
+	if (swap || dataOffset % sizeof(double) != 0) {
+		mBuffer.resize(mLength);
+		file.seekg(dataOffset, ios::beg);
+		file.read((char *) &mBuffer[0], mLength*sizeof(double));
+		if (swap) {
+			SwapBytes((char *) &mBuffer[0], mLength, sizeof(double));
+		}
+		mData = &mBuffer[0];
+		return;
+	}
+	file.close();
+
+#ifdef _WIN32
+	mFileHandle = CreateFileA(aName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL, NULL);
+	if (mFileHandle != INVALID_HANDLE_VALUE) {
+		mMappingHandle = CreateFileMappingA(mFileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mMappingHandle != NULL) {
+			mMapping = MapViewOfFile(mMappingHandle, FILE_MAP_READ, 0, 0, 0);
+		}
+	}
+#else
+	int fd = open(aName.c_str(), O_RDONLY);
+	if (fd >= 0) {
+		void *mapping = mmap(NULL, byteLength, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapping != MAP_FAILED) {
+			mMapping = mapping;
+			mMappingSize = byteLength;
+		}
+		close(fd);  // The mapping stays valid after the file has been closed.
+	}
+#endif
+
+	if (mMapping == NULL) {
+		mDims.clear();
+		mLength = 0;
+		mOpen = false;
+		return;
+	}
+	mData = (const double *) ((const char *) mMapping + dataOffset);
+}
+
+ArrayView::~ArrayView() {
+#ifdef _WIN32
+	if (mMapping != NULL) {
+		UnmapViewOfFile(mMapping);
+	}
+	if (mMappingHandle != NULL) {
+		CloseHandle(mMappingHandle);
+	}
+	if (mFileHandle != INVALID_HANDLE_VALUE) {
+		CloseHandle(mFileHandle);
+	}
+#else
+	if (mMapping != NULL) {
+		munmap(mMapping, mMappingSize);
+	}
+#endif
+}
@@ -1,17 +1,35 @@
 #ifndef ARRAYSAVE
 #define ARRAYSAVE
 
+#include <algorithm>
+#include <cstddef>
 #include <fstream>
+#include <string>
+#include <vector>
 
 using namespace std;
 
+// Functions that save arrays to binary files and read them back. The files
+// written by Save start with a header that has the int FILE_MAGIC, the int
+// FILE_VERSION, an int that specifies how many dimensions the array has and
+// one int for each dimension. The header is padded with zeros to a multiple of
+// 8 bytes, so that the elements are aligned when the file is mapped into
+// memory. Then the elements follow, in the byte order of the machine that
+// wrote the file, which the readers detect from FILE_MAGIC. The readers also
+// accept files in the older format, which has no magic number, version or
+// padding.
 class ArraySave {
 public:
+	// The first int in files with a versioned header.
+	static const int FILE_MAGIC = 0x31565341;
+	// The version of the header.
+	static const int FILE_VERSION = 1;
+
 	template <class type>
 	static void Save(int aNumDims, const int *aDims, const type *aArray, const char *aName) {
 
 	// Compute the number of elements in the array.
-	int N = 1;
+	size_t N = 1;
 	for (int d=0; d<aNumDims; d++) {
 		N = N*aDims[d];
 	}
@@ -19,11 +37,11 @@ public:
 	// Open file.
 	ofstream file(aName, ios::out|ios::binary);
 
-	// Write to file.
-	file.write((char *) &aNumDims, sizeof(int));
-	file.write((char *) aDims, sizeof(int)*aNumDims);
-	for(int n=0; n<N; n++) {
-		file.write((char *) (aArray+n), sizeof(type));
+	// Write the header and then all elements in large blocks.
+	WriteHeader(file, aNumDims, aDims);
+	const size_t chunk = WRITE_CHUNK / sizeof(type);
+	for (size_t n=0; n<N; n+=chunk) {
+		file.write((const char *) (aArray+n), (streamsize) (min(chunk, N-n)*sizeof(type)));
 	}
 	
 	file.close();
@@ -41,11 +59,10 @@ public:
 	//Save a 3D int matrix to a binary file
 	static void IntMatrixSave3(int am, int an, int ao, int ***aMat, const char *aName);
     
-    // Reads an array of doubles from a binary file. The files start with an
-    // int that specifies how many dimenstions the array has. Then have one
-    // int for each dimension, that specify the dimensions of the array.
-    // Finally they have the doubles of the array. The output is a vectorized
-    // version of the stored matrix (or tensor) and does not depend on dimensions.
+    // Reads an array of doubles from a binary file with the format described
+    // above. The output is a vectorized version of the stored matrix (or
+    // tensor) and does not depend on dimensions. ArrayView reads the array
+    // without copying it.
     //
     // Inputs:
     // aName - The full path of the binary file.
@@ -55,6 +72,124 @@ public:
     // A poniter to a double array with the double values. The array has to
     // be deleted by the caller.
     static double *ReadDouble(string aName, int *aLength);
+
+    // Reads the dimensions of an array in a binary file with the format
+    // described for ReadDouble. Returns an empty vector if the file can not
+    // be opened.
+    static vector<int> ReadDims(string aName);
+
+    // Reads the header of a binary file with the format described above.
+    //
+    // Inputs:
+    // aFile - Stream positioned at the start of the file.
+    // aDims - The dimensions of the array.
+    // aDataOffset - The number of bytes before the first element.
+    // aSwap - True if the file has the opposite byte order.
+    //
+    // Outputs:
+    // False if the header could not be read.
+    static bool ReadHeader(istream &aFile, vector<int> &aDims, size_t *aDataOffset, bool *aSwap);
+
+    // Appends the changes between two versions of an array of records to
+    // an append-only log file. Each record is a sequence of aRecordLength
+    // doubles. The log starts with an int that specifies the record length.
+    // Then it has one entry per call, with the ints aIteration, the number
+    // of records and the number of changed records, followed by the index
+    // (an int) and the doubles of every record which is new or differs
+    // from the record with the same index in aPrevious. The log is created
+    // if it does not exist. Records at the end of aPrevious that are not in
+    // aRecords are removed by the decrease of the number of records.
+    //
+    // Inputs:
+    // aName - The full path of the log file.
+    // aIteration - Number that identifies the entry.
+    // aRecordLength - The number of doubles in each record.
+    // aRecords - The current records, one after the other.
+    // aPrevious - The records in the previous entry, or an empty vector.
+    static void AppendChanges(string aName, int aIteration, int aRecordLength,
+        const vector<double> &aRecords, const vector<double> &aPrevious);
+
+    // Appends an entry to a log written by AppendChanges, when the changed
+    // records are already known, so that the other records do not have to
+    // be compared.
+    //
+    // Inputs:
+    // aName - The full path of the log file.
+    // aIteration - Number that identifies the entry.
+    // aRecordLength - The number of doubles in each record.
+    // aNumRecords - The current number of records.
+    // aChanged - The indices of the new and changed records, in increasing
+    //            order.
+    // aChangedRecords - The changed records, one after the other, in the
+    //                   same order as aChanged.
+    static void AppendRecords(string aName, int aIteration, int aRecordLength,
+        int aNumRecords, const vector<int> &aChanged, const vector<double> &aChangedRecords);
+
+    // Reconstructs the records of an entry in a log written by
+    // AppendChanges, by applying the changes in all entries up to and
+    // including the last entry with an iteration number that is not larger
+    // than aIteration. A negative aIteration gives the last entry.
+    //
+    // Inputs:
+    // aName - The full path of the log file.
+    // aIteration - Iteration number of the entry to reconstruct.
+    // aRecordLength - The number of doubles in each record.
+    // aRecords - The records of the entry, one after the other.
+    //
+    // Outputs:
+    // The iteration number of the reconstructed entry, or -1 if the file
+    // can not be opened or if there are no entries to reconstruct.
+    static int ReadChanges(string aName, int aIteration, int *aRecordLength,
+        vector<double> &aRecords);
+
+private:
+	// Saves are written in blocks of this many bytes.
+	static const size_t WRITE_CHUNK = 1 << 24;
+
+	// Writes the header described above to aFile.
+	static void WriteHeader(ofstream &aFile, int aNumDims, const int *aDims);
+};
+
+// Read-only view of an array of doubles in a binary file saved by
+// ArraySave::Save<double>. The file is mapped into memory, so the elements are
+// neither copied nor read from disk before they are accessed. Files with the
+// opposite byte order, and files in the older format where the elements are
+// not aligned, are instead read into a buffer that the view owns. The view
+// must exist as long as the elements are used.
+class ArrayView {
+public:
+	// Opens the file aName. IsOpen tells if that was successful.
+	ArrayView(string aName);
+
+	~ArrayView();
+
+	// Returns a pointer to the elements, or NULL if the array is empty.
+	const double *GetData() const { return mData; }
+
+	// Returns the dimensions of the array.
+	const vector<int> &GetDims() const { return mDims; }
+
+	// Returns the number of elements.
+	size_t GetLength() const { return mLength; }
+
+	// Returns true if the file could be read.
+	bool IsOpen() const { return mOpen; }
+
+private:
+	bool mOpen;
+	vector<int> mDims;
+	const double *mData;
+	size_t mLength;
+	vector<double> mBuffer;		// The elements, if the file is not mapped.
+	void *mMapping;				// Start of the mapped file, or NULL.
+	size_t mMappingSize;
+#ifdef _WIN32
+	void *mFileHandle;
+	void *mMappingHandle;
+#endif
+
+	ArrayView(const ArrayView &) = delete;
+	ArrayView &operator=(const ArrayView &) = delete;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,371 @@
+// Benchmark of the track linking in CellTrellis, on synthetic image sequences. The program generates
+// cells that move, divide and die in a square region, detects them with missed detections and false
+// positives, computes scores for the possible events, and links the detections by calling
+// CellTrellis::AddCell until no more cells can be added. It reports the time used to create the
+// trellis, the time of every search for the highest scoring path, the time spent executing paths and
+// replacing swaps, the number of swaps that were created and deleted, the time of Tree::GetCells, and
+// the peak memory of the process.
+//
+// The program does not depend on Matlab. It can be compiled from this folder using
+// g++ -O2 -std=c++11 -pthread ViterbiBenchmark.cpp $(ls ../*.cpp | grep -v ViterbiTrackLinking.cpp) -o ViterbiBenchmark
+//
+// Usage: ViterbiBenchmark [-option value]...
+//
+// Options:
+// -frames - The number of images. The default is 100.
+// -cells - The number of cells in the first image. The default is 50.
+// -neighbors - The number of detections in the next image that every detection can migrate to. The
+// default is 5.
+// -divisionRate - The probability that a cell divides between two images. The default is 0.01.
+// -deathRate - The probability that a cell dies between two images. The default is 0.005.
+// -seed - Seed of the random number generator. The default is 1.
+// -threads - The number of threads used by the CellTrellis. The default is 1.
+// -batchSize - See CellTrellis::SetBatchSize. The default is 1.
+// -lazySwaps - See CellTrellis::SetLazySwaps. The default is 0.
+// -windowed - See Trellis::SetWindowed. The default is 0.
+// -memoryReport - If this is 1, the memory used by the different arc types is printed using
+// CellTrellis::PrintMemory after the linking. The default is 0.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../CellTrellis.h"
+#include "../LogStream.h"
+#include "../Tree.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+// Returns the peak memory usage of the process in megabytes.
+static double PeakMemory() {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+	return counters.PeakWorkingSetSize / 1e6;
+#else
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+	return usage.ru_maxrss / 1e6;  // Bytes.
+#else
+	return usage.ru_maxrss / 1e3;  // Kilobytes.
+#endif
+#endif
+}
+
+// Returns the number of seconds since aStart.
+static double Seconds(chrono::steady_clock::time_point aStart) {
+	return chrono::duration<double>(chrono::steady_clock::now() - aStart).count();
+}
+
+// Appends a row with the elements aRow to the matrix aMatrix, where the rows are stored one after
+// the other.
+static void AddRow(vector<double> &aMatrix, const double *aRow, int aNumCols) {
+	aMatrix.insert(aMatrix.end(), aRow, aRow + aNumCols);
+}
+
+// Converts a matrix where the rows are stored one after the other into a column-major matrix, which
+// is the format that CellTrellis takes. The matrix always gets at least one element.
+static vector<double> ColumnMajor(const vector<double> &aRows, int aNumCols) {
+	int numRows = (int) aRows.size() / aNumCols;
+	vector<double> columns(max((int) aRows.size(), 1));
+	for (int i=0; i<numRows; i++) {
+		for (int j=0; j<aNumCols; j++) {
+			columns[j*numRows+i] = aRows[i*aNumCols+j];
+		}
+	}
+	return columns;
+}
+
+// Synthetic image sequence with scores for all events in the format of the inputs of CellTrellis.
+// Cells are placed uniformly in a square, with a density that does not depend on the number of
+// cells, and move with normally distributed steps. The detections are the cell positions plus
+// noise. 3 % of the cells are missed and 5 % false positives are added in every image.
+class SyntheticSequence {
+public:
+	// The maximum number of cells in a detection that count scores are given for.
+	static const int MAX_COUNT = 2;
+
+	SyntheticSequence(int aNumT, int aNumCells, int aNumNeighbors, double aDivisionRate, double aDeathRate,
+		unsigned aSeed);
+
+	int mNumT;
+	vector<double> mNumDets;
+	vector<double> mCountA;
+	vector<double> mMigA;
+	vector<double> mMitA;
+	vector<double> mApoA;
+	vector<double> mAppearA;
+	vector<double> mDisappearA;
+	int mNumMigs;
+	int mNumMits;
+	int mNumApos;
+	int mNumAppear;
+	int mNumDisappear;
+	int mTotalDets;
+};
+
+SyntheticSequence::SyntheticSequence(int aNumT, int aNumCells, int aNumNeighbors, double aDivisionRate,
+	double aDeathRate, unsigned aSeed) : mNumT(aNumT) {
+
+		const double STEP = 3.0;		// Standard deviation of the cell motion.
+		const double NOISE = 1.0;		// Standard deviation of the detection noise.
+		const double SPACING = 20.0;	// Average distance between cells.
+
+		mt19937 generator(aSeed);
+		uniform_real_distribution<double> uniform(0.0, 1.0);
+		normal_distribution<double> normal(0.0, 1.0);
+		double side = SPACING * sqrt((double) max(aNumCells, 1));
+
+		// Simulate the cells and detect them.
+		vector<pair<double, double> > cells;
+		for (int i=0; i<aNumCells; i++) {
+			cells.push_back(make_pair(side * uniform(generator), side * uniform(generator)));
+		}
+		vector<vector<pair<double, double> > > dets(aNumT);
+		vector<vector<bool> > real(aNumT);
+		for (int t=0; t<aNumT; t++) {
+			if (t > 0) {
+				vector<pair<double, double> > next;
+				for (int i=0; i<(int)cells.size(); i++) {
+					double r = uniform(generator);
+					if (r < aDeathRate) {
+						continue;
+					}
+					double x = cells[i].first + STEP * normal(generator);
+					double y = cells[i].second + STEP * normal(generator);
+					next.push_back(make_pair(x, y));
+					if (r > 1 - aDivisionRate) {
+						next.push_back(make_pair(x + 2 * STEP, y + STEP));
+					}
+				}
+				cells = next;
+			}
+			for (int i=0; i<(int)cells.size(); i++) {
+				if (uniform(generator) < 0.03) {
+					continue;
+				}
+				dets[t].push_back(make_pair(cells[i].first + NOISE * normal(generator),
+					cells[i].second + NOISE * normal(generator)));
+				real[t].push_back(true);
+			}
+			int numFalse = (int) (0.05 * cells.size());
+			for (int i=0; i<numFalse; i++) {
+				dets[t].push_back(make_pair(side * uniform(generator), side * uniform(generator)));
+				real[t].push_back(false);
+			}
+			mNumDets.push_back((double) dets[t].size());
+		}
+
+		// Compute scores. All scores are logarithms of probabilities.
+		vector<double> countRows, migRows, mitRows, apoRows, appearRows, disappearRows;
+		for (int t=0; t<aNumT; t++) {
+			for (int d=0; d<(int)dets[t].size(); d++) {
+				double p1 = real[t][d] ? 0.85 + 0.1 * uniform(generator) : 0.2 + 0.3 * uniform(generator);
+				double p2 = 0.04;
+				double p0 = 1 - p1 - p2;
+				double row[] = {t + 1.0, d + 1.0, log(p0), log(p1), log(p2)};
+				AddRow(countRows, row, MAX_COUNT + 3);
+			}
+		}
+		for (int t=0; t+1<aNumT; t++) {
+			for (int d=0; d<(int)dets[t].size(); d++) {
+				vector<pair<double, int> > neighbors;
+				for (int e=0; e<(int)dets[t+1].size(); e++) {
+					double dx = dets[t][d].first - dets[t+1][e].first;
+					double dy = dets[t][d].second - dets[t+1][e].second;
+					neighbors.push_back(make_pair(dx*dx + dy*dy, e));
+				}
+				int k = min((int) neighbors.size(), aNumNeighbors);
+				partial_sort(neighbors.begin(), neighbors.begin() + k, neighbors.end());
+
+				double variance = STEP*STEP + 2*NOISE*NOISE;
+				for (int i=0; i<k; i++) {
+					double p = exp(-neighbors[i].first / (2 * variance));
+					p = min(max(p, 1e-6), 1 - 1e-6);
+					double row[] = {t + 1.0, d + 1.0, neighbors[i].second + 1.0, log(1 - p), log(p)};
+					AddRow(migRows, row, 5);
+				}
+				for (int i=0; i<k; i++) {
+					for (int j=i+1; j<k; j++) {
+						double p = aDivisionRate * exp(-(neighbors[i].first + neighbors[j].first) / (4 * variance));
+						p = min(max(p, 1e-6), 1 - 1e-6);
+						double row[] = {t + 1.0, d + 1.0, neighbors[i].second + 1.0, neighbors[j].second + 1.0,
+							log(1 - p), log(p)};
+						AddRow(mitRows, row, 6);
+					}
+				}
+				double pApo = max(aDeathRate, 1e-6);
+				double apoRow[] = {t + 1.0, d + 1.0, log(1 - pApo), log(pApo)};
+				AddRow(apoRows, apoRow, 4);
+				double pDisappear = 0.02;
+				double disappearRow[] = {t + 1.0, d + 1.0, log(1 - pDisappear), log(pDisappear)};
+				AddRow(disappearRows, disappearRow, 4);
+			}
+		}
+		for (int t=1; t<aNumT; t++) {
+			for (int d=0; d<(int)dets[t].size(); d++) {
+				double pAppear = 0.02;
+				double row[] = {t + 1.0, d + 1.0, log(1 - pAppear), log(pAppear)};
+				AddRow(appearRows, row, 4);
+			}
+		}
+
+		mTotalDets = (int) countRows.size() / (MAX_COUNT + 3);
+		mNumMigs = (int) migRows.size() / 5;
+		mNumMits = (int) mitRows.size() / 6;
+		mNumApos = (int) apoRows.size() / 4;
+		mNumAppear = (int) appearRows.size() / 4;
+		mNumDisappear = (int) disappearRows.size() / 4;
+		mCountA = ColumnMajor(countRows, MAX_COUNT + 3);
+		mMigA = ColumnMajor(migRows, 5);
+		mMitA = ColumnMajor(mitRows, 6);
+		mApoA = ColumnMajor(apoRows, 4);
+		mAppearA = ColumnMajor(appearRows, 4);
+		mDisappearA = ColumnMajor(disappearRows, 4);
+}
+
+// Prints a row of the result table.
+static void PrintRow(string aName, double aTime, int aCount, string aRate) {
+	cout << left << setw(16) << aName << right << setw(12) << fixed << setprecision(4) << aTime
+		<< setw(10) << aCount << "   " << aRate << endl;
+}
+
+// Returns a string with a rate, given as aNumber per second.
+static string Rate(double aNumber, double aTime, string aUnit) {
+	stringstream rate;
+	rate << fixed << setprecision(1) << (aTime > 0 ? aNumber / aTime : 0.0) << " " << aUnit << "/s";
+	return rate.str();
+}
+
+int main(int argc, char *argv[]) {
+	int numT = 100;
+	int numCells = 50;
+	int numNeighbors = 5;
+	double divisionRate = 0.01;
+	double deathRate = 0.005;
+	unsigned seed = 1;
+	int numThreads = 1;
+	int batchSize = 1;
+	bool lazySwaps = false;
+	bool windowed = false;
+	bool memoryReport = false;
+
+	if (argc % 2 == 0) {
+		cerr << "The options must be given as -option value pairs." << endl;
+		return 1;
+	}
+	for (int i=1; i<argc; i+=2) {
+		string name = argv[i];
+		double value = atof(argv[i+1]);
+		if (name == "-frames") {
+			numT = (int) value;
+		} else if (name == "-cells") {
+			numCells = (int) value;
+		} else if (name == "-neighbors") {
+			numNeighbors = (int) value;
+		} else if (name == "-divisionRate") {
+			divisionRate = value;
+		} else if (name == "-deathRate") {
+			deathRate = value;
+		} else if (name == "-seed") {
+			seed = (unsigned) value;
+		} else if (name == "-threads") {
+			numThreads = (int) value;
+		} else if (name == "-batchSize") {
+			batchSize = (int) value;
+		} else if (name == "-lazySwaps") {
+			lazySwaps = (value != 0);
+		} else if (name == "-windowed") {
+			windowed = (value != 0);
+		} else if (name == "-memoryReport") {
+			memoryReport = (value != 0);
+		} else {
+			cerr << "Unknown option " << name << "." << endl;
+			return 1;
+		}
+	}
+
+	SyntheticSequence seq(numT, numCells, numNeighbors, divisionRate, deathRate, seed);
+	cout << "Sequence: " << numT << " images, " << seq.mTotalDets << " detections, " << seq.mNumMigs
+		<< " migrations, " << seq.mNumMits << " mitoses" << endl;
+	cout << "Settings: " << numThreads << " threads, batch size " << batchSize << ", lazy swaps "
+		<< lazySwaps << ", windowed " << windowed << endl << endl;
+
+	// The printouts of the trellis would dominate the run time.
+	lout.SetPrintout(false);
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	CellTrellis cellTrellis(false, numT, SyntheticSequence::MAX_COUNT, seq.mNumMigs, seq.mNumMits, seq.mNumApos,
+		seq.mNumAppear, seq.mNumDisappear, &seq.mNumDets[0], &seq.mCountA[0], &seq.mMigA[0], &seq.mMitA[0],
+		&seq.mApoA[0], &seq.mAppearA[0], &seq.mDisappearA[0], 0, numThreads);
+	cellTrellis.SetBatchSize(batchSize);
+	cellTrellis.SetLazySwaps(lazySwaps);
+	cellTrellis.SetWindowed(windowed);
+	double constructionTime = Seconds(start);
+
+	Tree *tree = cellTrellis.GetTree();
+	int numSearches = 0;
+	double searchTime = 0;
+	double maxSearchTime = 0;
+	double executionTime = 0;
+	start = chrono::steady_clock::now();
+	for (int iter=1; ; iter++) {
+		tree->SetIteration(iter);
+		chrono::steady_clock::time_point iterStart = chrono::steady_clock::now();
+		int addedCells = cellTrellis.AddCell();
+		double iterTime = Seconds(iterStart);
+		numSearches++;
+		searchTime += cellTrellis.GetSearchTime();
+		maxSearchTime = max(maxSearchTime, cellTrellis.GetSearchTime());
+		executionTime += iterTime - cellTrellis.GetSearchTime();
+		if (addedCells == 0) {
+			break;
+		}
+	}
+	double linkingTime = Seconds(start);
+
+	int numTreeCells = tree->GetNumCells();
+	vector<double> cellA(max(numT * numTreeCells, 1));
+	vector<double> divA(max(2 * numTreeCells, 1));
+	vector<double> deathA(max(numTreeCells, 1));
+	start = chrono::steady_clock::now();
+	tree->GetCells(&cellA[0], &divA[0], &deathA[0]);
+	double getCellsTime = Seconds(start);
+
+	cout << left << setw(16) << "Benchmark" << right << setw(12) << "Time (s)" << setw(10) << "Count"
+		<< "   Throughput" << endl;
+	cout << string(70, '-') << endl;
+	PrintRow("Construction", constructionTime, 1, Rate(seq.mTotalDets, constructionTime, "detections"));
+	PrintRow("Search", searchTime, numSearches, Rate(numSearches, searchTime, "searches"));
+	PrintRow("Execution", executionTime, numSearches - 1, Rate(numTreeCells, executionTime, "cells"));
+	PrintRow("Linking", linkingTime, numTreeCells, Rate(numTreeCells, linkingTime, "cells"));
+	PrintRow("GetCells", getCellsTime, 1, Rate(numT * numTreeCells, getCellsTime, "elements"));
+	cout << endl;
+	cout << "Mean search time: " << fixed << setprecision(3) << 1e3 * searchTime / numSearches
+		<< " ms, max search time: " << 1e3 * maxSearchTime << " ms" << endl;
+	cout << "Swaps created: " << cellTrellis.GetNumCreatedSwaps() << ", swaps deleted: "
+		<< cellTrellis.GetNumDeletedSwaps() << endl;
+	cout << "Peak memory: " << setprecision(1) << PeakMemory() << " MB" << endl;
+	if (memoryReport) {
+		cout << endl;
+		lout.SetPrintout(true);
+		cellTrellis.PrintMemory();
+	}
+	return 0;
+}
@@ -30,7 +30,7 @@ CellNode::~CellNode() {
 	mState->RemoveCell(this);
 }
 
-void CellNode::AddChildren(Mitosis *aMitosis, CellNode *aChild1, CellNode *aChild2) {
+void CellNode::AddChildren(Tree *aTree, Mitosis *aMitosis, CellNode *aChild1, CellNode *aChild2) {
     
     // Check that a child can be added.
     assert(mNextCell == NULL && mNextEvent == NULL);
@@ -45,6 +45,10 @@ void CellNode::AddChildren(Mitosis *aMitosis, CellNode *aChild1, CellNode *aChil
 		&& aChild1->mPrevCell->mPrevEvent == NULL);
 	assert(aMitosis->Check(mState, aChild1->GetState(), aChild2->GetState()));
 
+	aTree->MarkChanged(this);
+	aTree->MarkChanged(aChild1);
+	aTree->MarkChanged(aChild2);
+
     // Changes to parent cell.
 	mChildren[0] = aChild1;
 	mChildren[1] = aChild2;
@@ -59,11 +63,11 @@ void CellNode::AddChildren(Mitosis *aMitosis, CellNode *aChild1, CellNode *aChil
 	aChild2->mParent = this;
 }
 
-void CellNode::AddDependentSwap(Swap *aSwap) {
+void CellNode::AddDependentSwap(Arc *aSwap) {
 	mDependentSwaps.push_back(aSwap);
 }
 
-void CellNode::AddLink(Event *aEvent, CellNode *aCell) {
+void CellNode::AddLink(Tree *aTree, Event *aEvent, CellNode *aCell) {
 
 	// Check that the link is allowed.
 	assert(mNextCell == NULL && mNextEvent == NULL);
@@ -72,11 +76,15 @@ void CellNode::AddLink(Event *aEvent, CellNode *aCell) {
 	assert(!aCell->HasParent());
 	assert(aEvent->Check(mState, aCell->GetState()));
 
+	aTree->MarkChanged(this);
+	aTree->MarkChanged(aCell);
+
 	// Update members.
 	mNextEvent = aEvent;
 	mNextCell = aCell;
 	aCell->mPrevEvent = aEvent;
 	aCell->mPrevCell = this;
+	mNextEvent->AddCell(this);
 
 	// Update counters.
 	mNextEvent->Plus();
@@ -121,9 +129,14 @@ bool CellNode::HasPrevCell() const {
 void CellNode::RemoveChildren(Tree *aTree) {
 	assert(HasChildren());
 
+	aTree->MarkChanged(this);
+	aTree->MarkChanged(mChildren[0]);
+	aTree->MarkChanged(mChildren[1]);
+
 	// Remove the first child from aTree.
 	CellNode *prevCell1 = mChildren[0]->GetPrevCell();
 	Mitosis *mit1 = (Mitosis*) mChildren[0]->GetPrevEvent();
+	mit1->RemoveCell(prevCell1);
 	prevCell1->mNextEvent = NULL;
 	prevCell1->mNextCell = NULL;
 	//aTree->RemoveFirstCell(prevCell1);
@@ -135,6 +148,7 @@ void CellNode::RemoveChildren(Tree *aTree) {
 	// Remove the second child from aTree.
 	CellNode *prevCell2 = mChildren[1]->GetPrevCell();
 	Mitosis *mit2 = (Mitosis*) mChildren[1]->GetPrevEvent();
+	mit2->RemoveCell(prevCell2);
 	prevCell2->mNextEvent = NULL;
 	prevCell2->mNextCell = NULL;
 	//aTree->RemoveFirstCell(prevCell2);
@@ -155,11 +169,13 @@ void CellNode::RemoveChildren(Tree *aTree) {
 	mChildren[1] = NULL;
 }
 
-void CellNode::RemoveDependentSwaps() {
-	for (int i=0; i<(int)mDependentSwaps.size(); i++) {
+int CellNode::RemoveDependentSwaps() {
+	int numSwaps = (int) mDependentSwaps.size();
+	for (int i=0; i<numSwaps; i++) {
 		delete mDependentSwaps[i];
 	}
 	mDependentSwaps.clear();
+	return numSwaps;
 }
 
 void CellNode::RemoveLink(Tree *aTree) {
@@ -198,12 +214,16 @@ void CellNode::RemoveLink(Tree *aTree) {
         migToRemove->Minus();
             
         // Add back the migration that should be kept.
-		parent->AddLink((Event*) migToKeep, newNextCell);
+		parent->AddLink(aTree, (Event*) migToKeep, newNextCell);
 	} else {
 		// Removes a link between two CellNodes in a cell track.
 
+		aTree->MarkChanged(this);
+		aTree->MarkChanged(mNextCell);
+
 		mNextCell->mPrevEvent = NULL;
 		mNextCell->mPrevCell = NULL;
+		mNextEvent->RemoveCell(this);
 
 		// Update counters.
 		mNextCell->GetState()->Minus();
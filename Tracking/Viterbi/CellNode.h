@@ -1,12 +1,14 @@
 #ifndef CELLNODE
 #define CELLNODE
 
+#include <cstddef>  // To get size_t.
 #include <vector>
+#include "Arena.h"
 
+class Arc;
 class Event;
 class Mitosis;
 class State;
-class Swap;
 class Tree;
 
 using namespace std;
@@ -38,21 +40,24 @@ public:
 	// the child tracks were created.
 	//
 	// Inputs:
+	// aTree - Tree that the current CellNode is a part of.
 	// aMitosis - The mitosis event associated with the detections in the CellNodes.
 	// aChild1 - The CellNode wich will be the first child.
 	// aChild1 - The CellNode wich will be the second child.
-    void AddChildren(Mitosis *aMitosis, CellNode *aChild1, CellNode *aChild2);
+    void AddChildren(Tree *aTree, Mitosis *aMitosis, CellNode *aChild1, CellNode *aChild2);
 
-	void AddDependentSwap(Swap *aSwap);
+	// Adds a Swap or a SwapHub that has to be deleted when the cell track is changed at this CellNode.
+	void AddDependentSwap(Arc *aSwap);
 
 	// Links the current CellNode to another CellNode using a particular event. This will
 	// join two cell tracks together. The second track will often have only one CellNode.
 	// The function also updates the counters in aEvent and aCell.
 	//
 	// Inputs:
+	// aTree - Tree that the current CellNode is a part of.
 	// aEvent - Event used to link the current CellNode to aCell.
 	// aCell - The beginning of a cell track that will be linked to the current CellNode.
-	void AddLink(Event *aEvent, CellNode *aCell);
+	void AddLink(Tree *aTree, Event *aEvent, CellNode *aCell);
     
 	// Returns the state that the cell is associated with.
     State *GetState() { return mState; }
@@ -91,7 +96,9 @@ public:
 	// Returns false if the cell is the fist CellNode in a cell track.
 	bool HasPrevCell() const;
 
-	void RemoveDependentSwaps();
+	// Deletes the swaps and swap hubs that break the link to the previous CellNode, and returns
+	// the number of them.
+	int RemoveDependentSwaps();
 
 	// Removes the link between the current CellNode and the next CellNode in a cell.
 	// The function also updates the counters in Events and CellNodes. The function can
@@ -104,6 +111,10 @@ public:
 	// child is removed.  TODO: UPDATE COMMENT.
 	void RemoveLink(Tree *aTree);
 
+	// CellNodes are allocated from the current Arena.
+	static void *operator new(size_t aSize) { return Arena::Allocate(aSize); }
+	static void operator delete(void *aPointer, size_t aSize) { Arena::Free(aPointer, aSize); }
+
 private:
 	int mIteration;				// The iteration in which the cell was created.
 	State *mState;				// Detection or IdleState which is associated with the CellNode.
@@ -113,7 +124,7 @@ private:
 	CellNode *mChildren[2];		// The two child CellNodes of a CellNode that undergoes mitosis.
 	Event *mNextEvent;			// Event representing how the cell left mDetection.
 	Event *mPrevEvent;			// Event representing how the cell ended up in mDetection.
-	vector<Swap*> mDependentSwaps;
+	vector<Arc*> mDependentSwaps;	// Swaps and SwapHubs that break the link to mPrevCell.
 
 	// Creates a CellNode associated with the State aDetection. The constructor
 	// also adds the CellNode to the list of CellNodes in aDetection. Can only be called by Tree.
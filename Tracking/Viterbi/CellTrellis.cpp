@@ -1,8 +1,15 @@
 #include "CellTrellis.h"
+#include <algorithm>
 #include <assert.h>
+#include <chrono>
 #include <cstddef>  // To get NULL.
+#include <functional>
+#include <iomanip>
 #include <limits>
 #include <list>
+#include <set>
+#include <typeinfo>
+#include <utility>
 #include <vector>
 #include "Apoptosis.h"
 #include "Appearance.h"
@@ -14,6 +21,7 @@
 #include "Event.h"
 #include "FreeArc.h"
 #include "FreeArcNoSwap.h"
+#include "Hub.h"
 #include "IdleState.h"
 #include "LogStream.h"
 #include "Migration.h"
@@ -21,25 +29,70 @@
 #include "Node.h"
 #include "Persist.h"
 #include "Preexist.h"
+#include "ScoreMatrix.h"
+#include "ThreadPool.h"
 #include "Tree.h"
 #include "Trellis.h"
 #include "Swap.h"
+#include "SwapHub.h"
 
 using namespace std;
 
+// Returns the total number of detections in the aNumT images.
+static int NumDetections(int aNumT, const double *aNumTDets) {
+	int numDets = 0;
+	for (int t=0; t<aNumT; t++) {
+		numDets += (int) aNumTDets[t];
+	}
+	return numDets;
+}
+
+// Groups the rows of an input matrix by the image that the first column refers to,
+// minus aShift. The rows of image t are aRows[aOffsets[t]] to aRows[aOffsets[t+1]-1], and they are
+// in the same order as in the input matrix.
+static void GroupByImage(const ScoreMatrix &aA, int aNumT, int aShift, vector<int> &aOffsets, vector<int> &aRows) {
+	int n = aA.GetNumRows();
+	aOffsets.assign(aNumT+1, 0);
+	for (int i=0; i<n; i++) {
+		int t = aA.GetInt(i, 0) - 1 - aShift;
+		assert(t >= 0 && t < aNumT);
+		aOffsets[t+1]++;
+	}
+	for (int t=0; t<aNumT; t++) {
+		aOffsets[t+1] += aOffsets[t];
+	}
+	vector<int> next(aOffsets.begin(), aOffsets.end()-1);
+	aRows.resize(n);
+	for (int i=0; i<n; i++) {
+		int t = aA.GetInt(i, 0) - 1 - aShift;
+		aRows[next[t]++] = i;
+	}
+}
+
 // First the detections are generated and then all Event objects are added to them. The event
 // objects hold the probabilities for different events, and also serve as arcs in the trellis.
-CellTrellis::CellTrellis(bool singleIdleState, int aNumT, int aMaxCount, int aNumMigs, int aNumMits, int aNumApos, int aNumAppear, int aNumDisappear, double *aNumTDets,
-	double *aCountA, double *aMigA, double *aMitA, double *aApoA, double *aAppearA, double *aDisappearA, double aMaxMigScore) 
-	: Trellis(aNumT + 2), mSingleIdleState(singleIdleState) {
+//
+// The events are created in two phases. First the rows of the input matrices are grouped by image.
+// Then the events that start in each image are created, and the images are processed in parallel if
+// there are multiple threads. All events of an image start in the states of that image and end in the
+// states of the next image, so the arc lists and event tables that an image writes to are only written
+// by that image. For every image, the arcs of each state are counted before the events are created,
+// so that the storage for the arc lists can be allocated once. The events of every image are created
+// in the same order as if all events were created one type at a time, so the arc lists are identical
+// to the ones created serially. The nodes are added to the Trellis after the arcs, so that the arcs
+// do not change the Trellis while the images are processed.
+CellTrellis::CellTrellis(bool singleIdleState, int aNumT, int aMaxCount, const double *aNumTDets, const ScoreMatrix &aCount,
+	const ScoreMatrix &aMig, const ScoreMatrix &aMit, const ScoreMatrix &aApo, const ScoreMatrix &aAppear,
+	const ScoreMatrix &aDisappear, double aMaxMigScore, int aNumThreads)
+	: Trellis(aNumT + 2), mSingleIdleState(singleIdleState), mBatchSize(1), mLazySwaps(false), mMinScore(0),
+	mAddedScore(0), mSearchTime(0), mNumCreatedSwaps(0), mNumDeletedSwaps(0), mArena(new Arena()) {
+
+		SetNumThreads(aNumThreads);
+
+		ArenaScope arenaScope(mArena);
 
 		mTree = new Tree(aNumT);
 
-		int numDets = 0;  // Total number of detections.
-		for (int t=0; t<aNumT; t++) {
-			numDets += (int) aNumTDets[t];
-		}
-
 		mStartState = new IdleState(0,0);
 		mEndState = new IdleState(aNumT+1,0);
 
@@ -50,18 +103,6 @@ CellTrellis::CellTrellis(bool singleIdleState, int aNumT, int aMaxCount, int aNu
 				mDetections[t]->push_back(new Detection(t+1,d));
 			}
 		}
-		// Add count objects to detections.
-		double *tmpCountProbs = new double[aMaxCount+1];
-		for (int d=0; d<numDets; d++) {
-			int t = (int) aCountA[d] - 1;
-			int det = (int) aCountA[numDets+d] - 1;
-			for (int cnt=0; cnt<aMaxCount+1; cnt++) {
-				tmpCountProbs[cnt] = aCountA[(2+cnt)*numDets+d];
-			}
-			Count *tmpCount = new Count(0,  aMaxCount+1, tmpCountProbs); // Deleted by Detection.
-			mDetections[t]->at(det)->SetCount(tmpCount);
-		}
-		delete[] tmpCountProbs;
 
 		if (mSingleIdleState) {
 			for (int t=0; t<aNumT; t++) {
@@ -79,21 +120,6 @@ CellTrellis::CellTrellis(bool singleIdleState, int aNumT, int aMaxCount, int aNu
 			}
 		}
 
-		// Create nodes in the super class Trellis.
-		AddNode(0, mStartState);
-		for (int t=0; t<aNumT; t++) {
-			for (int d=0;d<aNumTDets[t];d++) {
-				AddNode(t+1, mDetections[t]->at(d));
-			}
-			if (mSingleIdleState) {
-				AddNode(t+1, mIdleStates[t]);
-			} else {
-				AddNode(t+1, mBornLaterStates[t]);
-				AddNode(t+1, mDeadStates[t]);
-			}
-		}
-		AddNode(aNumT+1, mEndState);
-
 		// Add preexist arcs to all detections in the first frame, to the starting state.
 		for ( int d=0; d<aNumTDets[0]; d++) {
 			new Preexist(mStartState, mDetections[0]->at(d));  // Deleted by State.
@@ -104,93 +130,164 @@ CellTrellis::CellTrellis(bool singleIdleState, int aNumT, int aMaxCount, int aNu
 			new Persist(mDetections[aNumT-1]->at(d), mEndState);  // Deleted by State.
 		}
 
-		// Add apoptosis arcs.
-		for (int d=0; d<aNumApos; d++) {
-			int t = (int) aApoA[d] - 1;
-			int det = (int) aApoA[aNumApos+d] - 1;
-			double apoProbs[2];
-			apoProbs[0] = aApoA[2*aNumApos+d];
-			apoProbs[1] = aApoA[3*aNumApos+d];
-
-			IdleState *toState = NULL;
-			if (mSingleIdleState) {
-				toState = mIdleStates[t+1];
-			} else {
-				toState = mDeadStates[t+1];
+		// Group the rows of the input matrices by the images that the events start in. Appearances
+		// start in the idle state of the previous image.
+		vector<int> countOffsets, countRows;
+		vector<int> apoOffsets, apoRows;
+		vector<int> mitOffsets, mitRows;
+		vector<int> migOffsets, migRows;
+		vector<int> appearOffsets, appearRows;
+		vector<int> disappearOffsets, disappearRows;
+		GroupByImage(aCount, aNumT, 0, countOffsets, countRows);
+		GroupByImage(aApo, aNumT, 0, apoOffsets, apoRows);
+		GroupByImage(aMit, aNumT, 0, mitOffsets, mitRows);
+		GroupByImage(aMig, aNumT, 0, migOffsets, migRows);
+		GroupByImage(aAppear, aNumT, 1, appearOffsets, appearRows);
+		GroupByImage(aDisappear, aNumT, 0, disappearOffsets, disappearRows);
+
+		// Creates the events that start in images aBegin to aEnd-1.
+		function<void(int, int)> createEvents = [&](int aBegin, int aEnd) {
+			vector<double> tmpCountProbs(aMaxCount+1);
+			for (int t=aBegin; t<aEnd; t++) {
+				vector<Detection*> &dets = *mDetections[t];
+				IdleState *fromState = mSingleIdleState ? mIdleStates[t] : mBornLaterStates[t];
+				IdleState *toState = NULL;
+				if (t+1 < aNumT) {
+					toState = mSingleIdleState ? mIdleStates[t+1] : mDeadStates[t+1];
+				}
+
+				// Count the arcs that will be added to the states.
+				vector<int> numForward(dets.size(), 0);
+				vector<int> numMigs(dets.size(), 0);
+				vector<int> numMits(dets.size(), 0);
+				vector<int> numBackward(t+1 < aNumT ? mDetections[t+1]->size() : 0, 0);
+				int numFromState = 0;
+				int numToState = 0;
+				for (int i=apoOffsets[t]; i<apoOffsets[t+1]; i++) {
+					numForward[aApo.GetInt(apoRows[i], 1) - 1]++;
+					numToState++;
+				}
+				for (int i=mitOffsets[t]; i<mitOffsets[t+1]; i++) {
+					int mit = mitRows[i];
+					numMits[aMit.GetInt(mit, 1) - 1] += 2;
+					numBackward[aMit.GetInt(mit, 2) - 1]++;
+					numBackward[aMit.GetInt(mit, 3) - 1]++;
+					numFromState += 2;
+				}
+				for (int i=migOffsets[t]; i<migOffsets[t+1]; i++) {
+					int mig = migRows[i];
+					numForward[aMig.GetInt(mig, 1) - 1]++;
+					numMigs[aMig.GetInt(mig, 1) - 1]++;
+					numBackward[aMig.GetInt(mig, 2) - 1]++;
+				}
+				for (int i=appearOffsets[t]; i<appearOffsets[t+1]; i++) {
+					numBackward[aAppear.GetInt(appearRows[i], 1) - 1]++;
+					numFromState++;
+				}
+				for (int i=disappearOffsets[t]; i<disappearOffsets[t+1]; i++) {
+					numForward[aDisappear.GetInt(disappearRows[i], 1) - 1]++;
+					numToState++;
+				}
+				for (int d=0; d<(int)dets.size(); d++) {
+					dets[d]->ReserveForwardArcs(numForward[d]);
+					dets[d]->ReserveEvents(numMigs[d], numMits[d]);
+				}
+				for (int d=0; d<(int)numBackward.size(); d++) {
+					mDetections[t+1]->at(d)->ReserveBackwardArcs(numBackward[d]);
+				}
+				fromState->ReserveForwardArcs(numFromState);
+				if (toState != NULL) {
+					toState->ReserveBackwardArcs(numToState);
+				}
+
+				// Add count objects to detections.
+				for (int i=countOffsets[t]; i<countOffsets[t+1]; i++) {
+					int d = countRows[i];
+					int det = aCount.GetInt(d, 1) - 1;
+					for (int cnt=0; cnt<aMaxCount+1; cnt++) {
+						tmpCountProbs[cnt] = aCount.Get(d, 2+cnt);
+					}
+					Count *tmpCount = new Count(0,  aMaxCount+1, &tmpCountProbs[0]); // Deleted by Detection.
+					dets[det]->SetCount(tmpCount);
+				}
+
+				// Add apoptosis arcs.
+				for (int i=apoOffsets[t]; i<apoOffsets[t+1]; i++) {
+					int d = apoRows[i];
+					int det = aApo.GetInt(d, 1) - 1;
+					double apoProbs[2];
+					apoProbs[0] = aApo.Get(d, 2);
+					apoProbs[1] = aApo.Get(d, 3);
+
+					new Apoptosis(dets[det], toState, 0 , 2 , apoProbs);  // Deleted by State.
+				}
+
+				// Add mitosis arcs.
+				for (int i=mitOffsets[t]; i<mitOffsets[t+1]; i++) {
+					int d = mitRows[i];
+					int detParent = aMit.GetInt(d, 1) - 1;
+					int detChild1 = aMit.GetInt(d, 2) - 1;
+					int detChild2 = aMit.GetInt(d, 3) - 1;
+					double mitProbs[2];
+					mitProbs[0] = aMit.Get(d, 4);
+					mitProbs[1] = aMit.Get(d, 5);
+
+					// There are two copies of all mitosis events. They link to different daughther cell detections.
+					Mitosis *mit = new Mitosis(fromState, mDetections[t+1]->at(detChild1), dets[detParent], mDetections[t+1]->at(detChild2), 0, 2, mitProbs);  // Deleted by State.
+					Mitosis *mitMirror = new Mitosis(fromState, mDetections[t+1]->at(detChild2), dets[detParent], mDetections[t+1]->at(detChild1), 0, 2, mitProbs);  // Deleted by State.
+					mit->LinkMirror(mitMirror);
+				}
+
+				// Add migration arcs.
+				for (int i=migOffsets[t]; i<migOffsets[t+1]; i++) {
+					int d = migRows[i];
+					int det1 = aMig.GetInt(d, 1) - 1;
+					int det2 = aMig.GetInt(d, 2) - 1;
+					double migProbs[2];
+					migProbs[0] = aMig.Get(d, 3);
+					migProbs[1] = aMig.Get(d, 4);
+					new Migration(dets[det1], mDetections[t+1]->at(det2), 0, 2, migProbs, aMaxMigScore);  // Deleted by State.
+				}
+
+				// Add appearance arcs, to detections in the next image.
+				// TODO: MAKE SURE THAT NO CELLS ARE SET TO APPEAR IN THE FIRST IMAGE.
+				for (int i=appearOffsets[t]; i<appearOffsets[t+1]; i++) {
+					int d = appearRows[i];
+					int det = aAppear.GetInt(d, 1) - 1;
+					double appearProbs[2];
+					appearProbs[0] = aAppear.Get(d, 2);
+					appearProbs[1] = aAppear.Get(d, 3);
+
+					new Appearance(fromState, mDetections[t+1]->at(det), 0, 2, appearProbs);  // Deleted by State.
+				}
+
+				// Add disappearance arcs.
+				for (int i=disappearOffsets[t]; i<disappearOffsets[t+1]; i++) {
+					int d = disappearRows[i];
+					int det = aDisappear.GetInt(d, 1) - 1;
+					double disappearProbs[2];
+					disappearProbs[0] = aDisappear.Get(d, 2);
+					disappearProbs[1] = aDisappear.Get(d, 3);
+
+					new Disappearance(dets[det], toState, 0, 2, disappearProbs);  // Deleted by State.
+				}
 			}
+		};
 
-			new Apoptosis(mDetections[t]->at(det), toState, 0 , 2 , apoProbs);  // Deleted by State.
-		}
-
-		// Add mitosis arcs.
-		for (int d=0; d<aNumMits; d++) {
-			int t = (int) aMitA[d] - 1;
-			int detParent = (int) aMitA[aNumMits+d] - 1;
-			int detChild1 = (int) aMitA[2*aNumMits+d] - 1;
-			int detChild2 = (int) aMitA[3*aNumMits+d] - 1;
-			double mitProbs[2];
-			mitProbs[0] = aMitA[4*aNumMits+d];
-			mitProbs[1] = aMitA[5*aNumMits+d];
-
-			IdleState *fromState = NULL;
-			if (mSingleIdleState) {
-				fromState = mIdleStates[t];
-			} else {
-				fromState = mBornLaterStates[t];
-			}
-			
-			// There are two copies of all mitosis events. They link to different daughther cell detections.
-			Mitosis *mit = new Mitosis(fromState, mDetections[t+1]->at(detChild1), mDetections[t]->at(detParent), mDetections[t+1]->at(detChild2), 0, 2, mitProbs);  // Deleted by State.
-			Mitosis *mitMirror = new Mitosis(fromState, mDetections[t+1]->at(detChild2), mDetections[t]->at(detParent), mDetections[t+1]->at(detChild1), 0, 2, mitProbs);  // Deleted by State.
-			mit->LinkMirror(mitMirror);
-		}
-
-		// Add migration arcs.
-		for ( int d=0; d<aNumMigs; d++) {
-			int t = (int) aMigA[d] - 1;
-			int det1 = (int) aMigA[aNumMigs+d] - 1;
-			int det2 = (int) aMigA[2*aNumMigs+d] - 1;
-			double migProbs[2];
-			migProbs[0] = aMigA[3*aNumMigs+d];
-			migProbs[1] = aMigA[4*aNumMigs+d];
-			new Migration(mDetections[t]->at(det1), mDetections[t+1]->at(det2), 0, 2, migProbs, aMaxMigScore);  // Deleted by State.
-		}
-        
-		// Add appearance arcs.
-		// TODO: MAKE SURE THAT NO CELLS ARE SET TO APPEAR IN THE FIRST IMAGE.
-		for ( int d=0; d<aNumAppear; d++) {
-			int t = (int) aAppearA[d] - 1;
-			int det = (int) aAppearA[aNumAppear+d] - 1;
-			double appearProbs[2];
-			appearProbs[0] = aAppearA[2*aNumAppear+d];
-			appearProbs[1] = aAppearA[3*aNumAppear+d];
-			
-			IdleState *fromState = NULL;
-			if (mSingleIdleState) {
-				fromState = mIdleStates[t-1];
-			} else {
-				fromState = mBornLaterStates[t-1];
-			}
-			
-			new Appearance(fromState, mDetections[t]->at(det), 0, 2, appearProbs);  // Deleted by State.
-		}
-        
-		// Add disappearance arcs.
-		for ( int d=0; d<aNumDisappear; d++) {
-			int t = (int) aDisappearA[d] - 1;
-			int det = (int) aDisappearA[aNumDisappear+d] - 1;
-			double disappearProbs[2];
-			disappearProbs[0] = aDisappearA[2*aNumDisappear+d];
-			disappearProbs[1] = aDisappearA[3*aNumDisappear+d];
-
-			IdleState *toState = NULL;
-			if (mSingleIdleState) {
-				toState = mIdleStates[t+1];
-			} else {
-				toState = mDeadStates[t+1];
+		ThreadPool *threadPool = GetThreadPool();
+		if (threadPool == NULL) {
+			createEvents(0, aNumT);
+		} else {
+			// Every chunk of images gets its own Arena, as an Arena can only be used by one thread at a time.
+			int chunk = max(1, aNumT / (4 * threadPool->GetNumThreads()));
+			int numChunks = (aNumT + chunk - 1) / chunk;
+			for (int i=0; i<numChunks; i++) {
+				mBuildArenas.push_back(new Arena());
 			}
-
-			new Disappearance(mDetections[t]->at(det), toState, 0, 2, disappearProbs);  // Deleted by State.
+			threadPool->ParallelFor(aNumT, chunk, [&](int aBegin, int aEnd) {
+				ArenaScope chunkArenaScope(mBuildArenas[aBegin / chunk]);
+				createEvents(aBegin, aEnd);
+			});
 		}
 
 		// Free arcs that don't represent cell events. All FreeArcs are deleted by State.
@@ -214,13 +311,38 @@ CellTrellis::CellTrellis(bool singleIdleState, int aNumT, int aMaxCount, int aNu
 		}
 		// Adds swap arcs.
 		// AddSwaps();
+
+		// Create nodes in the super class Trellis.
+		AddNode(0, mStartState);
+		vector<Node*> layer;
+		for (int t=0; t<aNumT; t++) {
+			layer.assign(mDetections[t]->begin(), mDetections[t]->end());
+			if (mSingleIdleState) {
+				layer.push_back(mIdleStates[t]);
+			} else {
+				layer.push_back(mBornLaterStates[t]);
+				layer.push_back(mDeadStates[t]);
+			}
+			AddNodes(t+1, layer);
+		}
+		AddNode(aNumT+1, mEndState);
 }
 
-// The nodes are deleted by Trellis, and the arcs are deleted by the nodes.
+CellTrellis::CellTrellis(bool singleIdleState, int aNumT, int aMaxCount, int aNumMigs, int aNumMits, int aNumApos, int aNumAppear, int aNumDisappear, double *aNumTDets,
+	double *aCountA, double *aMigA, double *aMitA, double *aApoA, double *aAppearA, double *aDisappearA, double aMaxMigScore, int aNumThreads)
+	: CellTrellis(singleIdleState, aNumT, aMaxCount, aNumTDets, ScoreMatrix(aCountA, NumDetections(aNumT, aNumTDets), aMaxCount+3),
+	ScoreMatrix(aMigA, aNumMigs, 5), ScoreMatrix(aMitA, aNumMits, 6), ScoreMatrix(aApoA, aNumApos, 4),
+	ScoreMatrix(aAppearA, aNumAppear, 4), ScoreMatrix(aDisappearA, aNumDisappear, 4), aMaxMigScore, aNumThreads) {
+}
+
+// The nodes and the arcs are deleted before the Arena that they are allocated from.
 CellTrellis::~CellTrellis() {
 	delete mTree;  // Must be destoryed before the states.
-
-	// All of the states are destroyed by ~Trellis().
+	DeleteNodes(true);
+	delete mArena;
+	for (int i=0; i<(int)mBuildArenas.size(); i++) {
+		delete mBuildArenas[i];
+	}
 
 	//for (int t=0; t<(int)mDetections.size(); t++) {
 	//	for (int d=0; d<(int)mDetections[t]->size(); d++) {
@@ -238,71 +360,473 @@ CellTrellis::~CellTrellis() {
 int CellTrellis::AddCell() {
 	// Adds a singe cell to the mTree if that increases the score.
 
+	ArenaScope arenaScope(mArena);
+
 	list<Arc*> sPath;
 	double score;
+	chrono::steady_clock::time_point searchStart = chrono::steady_clock::now();
 	HighestScoringPath(sPath, score);
+	mSearchTime = chrono::duration<double>(chrono::steady_clock::now() - searchStart).count();
 
-	vector<CellNode*> newCells;
+	mAddedScore = 0;
+	if (score <= mMinScore) {
+		return 0;
+	}
 
-	if (score > 0) {
-		for (list<Arc*>::iterator lIt = sPath.begin(); lIt!=sPath.end() ; ++lIt) { // THE ARCS HAVE TO BE CONVERTED BACK TO OPERATIONARCS
-			((Event*) *lIt)->Execute(mTree, &newCells); // MAYBE EXECUTE SHOULD TAKE THE TREE AS AN INPUT.
+	// The candidates have to be found before the tables change.
+	vector<list<Arc*> > candidates;
+	vector<vector<CellNode*> > swapCells;
+	if (mBatchSize > 1) {
+		CandidatePaths(sPath, candidates, swapCells);
+	}
+
+	set<CellNode*> changedCells;
+	ExecutePath(sPath, &changedCells);
+	int addedCells = 1;
+	mAddedScore = score;
+
+	// The scores of the candidates may have changed when the previous paths were executed. The swaps
+	// of changed CellNodes have been deleted, so candidates with such swaps are skipped. The other
+	// swaps are still valid for the current tree, in the same way as between two searches.
+	for (int i=0; i<(int)candidates.size(); i++) {
+		bool deleted = false;
+		for (int j=0; j<(int)swapCells[i].size(); j++) {
+			if (changedCells.count(swapCells[i][j]) > 0) {
+				deleted = true;
+			}
 		}
+		if (deleted) {
+			continue;
+		}
+
+		double candidateScore = 0;
+		for (list<Arc*>::iterator lIt = candidates[i].begin(); lIt!=candidates[i].end() ; ++lIt) {
+			candidateScore += (*lIt)->GetScore();
+		}
+		if (candidateScore > mMinScore) {
+			ExecutePath(candidates[i], &changedCells);
+			addedCells++;
+			mAddedScore += candidateScore;
+		}
+	}
+	return addedCells;
+}
+
+void CellTrellis::ExecutePath(list<Arc*> &aPath, set<CellNode*> *aChangedCells) {
+	vector<CellNode*> newCells;
+	bool print = lout.IsVerbose(LogStream::VERBOSITY_EVENTS);
+
+	for (list<Arc*>::iterator lIt = aPath.begin(); lIt!=aPath.end() ; ++lIt) { // THE ARCS HAVE TO BE CONVERTED BACK TO OPERATIONARCS
+		((Event*) *lIt)->Execute(mTree, &newCells, print); // MAYBE EXECUTE SHOULD TAKE THE TREE AS AN INPUT.
+	}
+	if (lout.IsVerbose(LogStream::VERBOSITY_ITERATIONS)) {
 		lout << "The tree has " << setw(0) <<  mTree->GetNumCells() << " cells." << endl;
 		lout << endl;  // Separate output from different iterations.
+	}
 
-		// Replace the swap events.
-		// RemoveSwaps();
-		// AddSwaps();
+	// Replace the swap events.
+	// RemoveSwaps();
+	// AddSwaps();
+
+	//for (int i=0; i<(int)newCells.size(); i++) {
+	//	if (newCells[i] == NULL) {
+	//		// FreeArc.
+	//		continue;
+	//	}
+
+	//	AddSwaps(newCells[i]);
+	//	if (i < newCells.size()-1 && newCells[i+1] != newCells[i]->GetNextCell()) {
+	//		AddSwaps(newCells[i]->GetNextCell());
+	//	}
+
+	//	//if (i==0 || newCells[i-1] != newCells[i]->GetPrevCell()) {
+	//	//	AddSwaps(newCells[i]->GetPrevCell());
+	//	//}
+	//	//if (i < newCells.size()-1) {
+	//	//	AddSwaps(newCells[i]);
+	//	//}
+	//}
+
+	//list<Arc*> sPath2;
+	//double score2;
+	//HighestScoringPath(sPath2, score2);
+
+	if (aChangedCells != NULL) {
+		aChangedCells->insert(newCells.begin(), newCells.end());
+	}
+	for (int i=0; i<(int)newCells.size(); i++) {
+		mNumDeletedSwaps += newCells[i]->RemoveDependentSwaps();
+		if (!newCells[i]->HasNextCell() && !newCells[i]->HasPrevCell()) {
+			// This CellNode was left after a swap that started with a FreeArc.
+			mTree->DeleteCell(newCells[i]);
+		} else {
+			AddSwaps(newCells[i]);
+		}
+	}
+
+	//list<Arc*> sPath3;
+	//double score3;
+	//HighestScoringPath(sPath3, score3);
+
+	//for (int i=0; i<(int)newCells.size(); i++) {
+	//	AddSwaps(newCells[i]);
+	//}
+
+	//list<Arc*> sPath4;
+	//double score4;
+	//HighestScoringPath(sPath4, score4);
+}
+
+// Returns the first event of class T that goes from aStart to aEnd, or NULL if there is no such event.
+template <class T>
+static T *FindEvent(State *aStart, State *aEnd) {
+	for (int i=0; i<aStart->GetNumForwardArcs(); i++) {
+		Event *event = (Event*) aStart->GetForwardArc(i);
+		T *found = dynamic_cast<T*>(event);
+		if (found != NULL && event->GetEndState() == aEnd) {
+			return found;
+		}
+	}
+	return NULL;
+}
+
+// Finds the first and the last image that cell aCell is present in, in a cell matrix with aNumT
+// images. Returns false if the cell is not present in any image or if it is missing in an image
+// between the first and the last image.
+static bool CellImages(const double *aCellA, int aNumT, int aCell, int &aFirst, int &aLast) {
+	aFirst = -1;
+	aLast = -1;
+	for (int t=0; t<aNumT; t++) {
+		if (aCellA[aCell*aNumT+t] > 0) {
+			if (aFirst == -1) {
+				aFirst = t;
+			} else if (aLast != t-1) {
+				return false;
+			}
+			aLast = t;
+		}
+	}
+	return aFirst != -1;
+}
 
-		//for (int i=0; i<(int)newCells.size(); i++) {
-		//	if (newCells[i] == NULL) {
-		//		// FreeArc.
-		//		continue;
-		//	}
-
-		//	AddSwaps(newCells[i]);
-		//	if (i < newCells.size()-1 && newCells[i+1] != newCells[i]->GetNextCell()) {
-		//		AddSwaps(newCells[i]->GetNextCell());
-		//	}
-
-		//	//if (i==0 || newCells[i-1] != newCells[i]->GetPrevCell()) {
-		//	//	AddSwaps(newCells[i]->GetPrevCell());
-		//	//}
-		//	//if (i < newCells.size()-1) {
-		//	//	AddSwaps(newCells[i]);
-		//	//}
-		//}
-
-		//list<Arc*> sPath2;
-		//double score2;
-		//HighestScoringPath(sPath2, score2);
-
-		for (int i=0; i<(int)newCells.size(); i++) {
-			newCells[i]->RemoveDependentSwaps();
-			if (!newCells[i]->HasNextCell() && !newCells[i]->HasPrevCell()) {
-				// This CellNode was left after a swap that started with a FreeArc.
-				delete newCells[i];
+void CellTrellis::PrintMemory() {
+	// The arc types that are counted.
+	struct ArcType {
+		const type_info *type;
+		const char *name;
+		size_t size;
+		long long count;
+	};
+	ArcType types[] = {
+		{&typeid(Apoptosis), "Apoptosis", sizeof(Apoptosis), 0},
+		{&typeid(Appearance), "Appearance", sizeof(Appearance), 0},
+		{&typeid(Disappearance), "Disappearance", sizeof(Disappearance), 0},
+		{&typeid(FreeArc), "FreeArc", sizeof(FreeArc), 0},
+		{&typeid(FreeArcNoSwap), "FreeArcNoSwap", sizeof(FreeArcNoSwap), 0},
+		{&typeid(Migration), "Migration", sizeof(Migration), 0},
+		{&typeid(Mitosis), "Mitosis", sizeof(Mitosis), 0},
+		{&typeid(Persist), "Persist", sizeof(Persist), 0},
+		{&typeid(Preexist), "Preexist", sizeof(Preexist), 0},
+		{&typeid(Swap), "Swap", sizeof(Swap), 0},
+		{&typeid(SwapHub), "SwapHub", sizeof(SwapHub), 0}};
+	int numTypes = sizeof(types) / sizeof(types[0]);
+	long long numOther = 0;  // Arcs of other types.
+	long long numArcs = 0;
+
+	// Count the arcs in the arc lists of the nodes and the hubs.
+	vector<Arc*> arcs;
+	for (int t=0; t<mNumT; t++) {
+		for (int n=0; n<GetNumNodes(t); n++) {
+			Node *node = GetNode(t, n);
+			for (int a=0; a<node->GetNumForwardArcs(); a++) {
+				arcs.push_back(node->GetForwardArc(a));
+			}
+		}
+		const vector<Hub*> &hubs = GetHubs(t);
+		for (int h=0; h<(int)hubs.size(); h++) {
+			if (hubs[h] != NULL) {
+				arcs.push_back(hubs[h]);
+			}
+		}
+		for (int i=0; i<(int)arcs.size(); i++) {
+			const type_info &type = typeid(*arcs[i]);
+			int j = 0;
+			while (j < numTypes && type != *types[j].type) {
+				j++;
+			}
+			if (j < numTypes) {
+				types[j].count++;
 			} else {
-				AddSwaps(newCells[i]);
+				numOther++;
+			}
+		}
+		numArcs += (int) arcs.size();
+		arcs.clear();
+	}
+
+	// Count objects and their scores.
+	long long numCounts = 0;
+	size_t countBytes = 0;
+	for (int t=0; t<(int)mDetections.size(); t++) {
+		for (int d=0; d<(int)mDetections[t]->size(); d++) {
+			Count *count = mDetections[t]->at(d)->GetCount();
+			if (count != NULL) {
+				numCounts++;
+				countBytes += Arena::GetAllocatedSize(sizeof(Count));
+				if (count->GetNumScoreBytes() > 0) {
+					countBytes += Arena::GetAllocatedSize(count->GetNumScoreBytes());
+				}
 			}
 		}
+	}
 
-		//list<Arc*> sPath3;
-		//double score3;
-		//HighestScoringPath(sPath3, score3);
+	size_t arenaBytes = mArena->GetNumBytes();
+	for (int i=0; i<(int)mBuildArenas.size(); i++) {
+		arenaBytes += mBuildArenas[i]->GetNumBytes();
+	}
 
-		//for (int i=0; i<(int)newCells.size(); i++) {
-		//	AddSwaps(newCells[i]);
-		//}
+	lout << "Memory of the trellis:" << endl;
+	size_t arcBytes = 0;
+	for (int j=0; j<numTypes; j++) {
+		if (types[j].count == 0) {
+			continue;
+		}
+		size_t bytes = types[j].count * Arena::GetAllocatedSize(types[j].size);
+		arcBytes += bytes;
+		lout << setw(15) << left << types[j].name << right << setw(12) << types[j].count << " arcs"
+			<< setw(14) << bytes << " bytes" << setw(6) << Arena::GetAllocatedSize(types[j].size) << " bytes per arc" << endl;
+	}
+	if (numOther > 0) {
+		lout << setw(15) << left << "Other" << right << setw(12) << numOther << " arcs" << endl;
+	}
+	lout << "Arc lists: " << numArcs * 2 * sizeof(Arc*) << " bytes" << endl;
+	lout << "Counts: " << numCounts << " objects, " << countBytes << " bytes" << endl;
+	lout << "Arcs: " << arcBytes << " bytes, arenas: " << arenaBytes << " bytes" << endl << endl;
+}
 
-		//list<Arc*> sPath4;
-		//double score4;
-		//HighestScoringPath(sPath4, score4);
+// The states that a track goes through are found first, and then the events between consecutive
+// states are looked up. The events of a track are only executed if all of them exist.
+int CellTrellis::WarmStart(int aNumCells, const double *aCellA, const double *aDivA, const double *aDeathA) {
+	ArenaScope arenaScope(mArena);
+
+	int numT = (int) mDetections.size();
+
+	// Daughter cells and parents, or -1 if there are none.
+	vector<int> children1(aNumCells, -1);
+	vector<int> children2(aNumCells, -1);
+	vector<int> parents(aNumCells, -1);
+	for (int c=0; c<aNumCells; c++) {
+		int child1 = (int) aDivA[c] - 1;
+		int child2 = (int) aDivA[aNumCells+c] - 1;
+		if (child1 >= 0 && child1 < aNumCells && child2 >= 0 && child2 < aNumCells && child1 != child2
+			&& parents[child1] == -1 && parents[child2] == -1) {
+				children1[c] = child1;
+				children2[c] = child2;
+				parents[child1] = c;
+				parents[child2] = c;
+		}
+	}
 
-		return 1;
-	} else {
-		return 0;
+	// Cells that start tracks. Second daughter cells are added when the tracks of their parents
+	// have been added.
+	vector<int> trackStarts;
+	for (int c=0; c<aNumCells; c++) {
+		if (parents[c] == -1) {
+			trackStarts.push_back(c);
+		}
+	}
+
+	int numAdded = 0;
+	for (int i=0; i<(int)trackStarts.size(); i++) {
+		// The cells in the track and the states that the track goes through.
+		vector<int> cells;
+		vector<State*> states;
+		states.push_back(mStartState);
+
+		bool ok = true;
+		int c = trackStarts[i];
+		int lastT = -1;
+		while (true) {
+			int first, last;
+			if (!CellImages(aCellA, numT, c, first, last) || (lastT != -1 && first != lastT+1)) {
+				ok = false;
+				break;
+			}
+			cells.push_back(c);
+			if (lastT == -1) {
+				for (int t=0; t<first; t++) {
+					states.push_back(GetBornLaterState(t));
+				}
+			}
+			for (int t=first; t<=last; t++) {
+				int d = (int) aCellA[c*numT+t] - 1;
+				if (d < 0 || d >= (int)mDetections[t]->size()) {
+					ok = false;
+					break;
+				}
+				states.push_back(mDetections[t]->at(d));
+			}
+			lastT = last;
+			if (!ok || children1[c] == -1) {
+				break;
+			}
+			c = children1[c];  // The first daughter cell continues the track.
+		}
+		if (!ok) {
+			continue;
+		}
+		for (int t=lastT+1; t<numT; t++) {
+			states.push_back(GetDeadState(t));
+		}
+		states.push_back(mEndState);
+
+		bool dies = (aDeathA[cells.back()] != 0);
+
+		list<Arc*> path;
+		for (int j=0; j<(int)states.size()-1 && ok; j++) {
+			Detection *det1 = dynamic_cast<Detection*>(states[j]);
+			Detection *det2 = dynamic_cast<Detection*>(states[j+1]);
+			Event *event = NULL;
+
+			if (det1 != NULL && det2 != NULL) {
+				event = det1->GetMigration(det2);
+			} else if (det2 != NULL && states[j] == mStartState) {
+				event = FindEvent<Preexist>(states[j], states[j+1]);
+			} else if (det2 != NULL && parents[cells[0]] != -1) {
+				// A second daughter cell is created by the Mitosis that replaces the migration
+				// from the parent to the first daughter cell.
+				int parent = parents[cells[0]];
+				int parentFirst, parentLast, siblingFirst, siblingLast;
+				CellImages(aCellA, numT, parent, parentFirst, parentLast);
+				CellImages(aCellA, numT, children1[parent], siblingFirst, siblingLast);
+				Detection *parentDet = mDetections[parentLast]->at((int) aCellA[parent*numT+parentLast] - 1);
+				Detection *siblingDet = mDetections[siblingFirst]->at((int) aCellA[children1[parent]*numT+siblingFirst] - 1);
+				Detection::MitosisIterator first, last;
+				parentDet->GetMitosis(siblingDet, first, last);
+				for (Detection::MitosisIterator it=first; it!=last; ++it) {
+					if ((*it)->GetStartState() == states[j] && (*it)->GetEndState() == states[j+1]) {
+						event = *it;
+						break;
+					}
+				}
+			} else if (det2 != NULL) {
+				event = FindEvent<Appearance>(states[j], states[j+1]);
+			} else if (det1 != NULL && states[j+1] == mEndState) {
+				event = FindEvent<Persist>(states[j], states[j+1]);
+			} else if (det1 != NULL && dies) {
+				event = FindEvent<Apoptosis>(states[j], states[j+1]);
+			} else if (det1 != NULL) {
+				event = FindEvent<Disappearance>(states[j], states[j+1]);
+			} else {
+				event = FindEvent<FreeArc>(states[j], states[j+1]);
+			}
+
+			if (event == NULL) {
+				ok = false;
+			} else {
+				path.push_back(event);
+			}
+		}
+		if (!ok) {
+			continue;
+		}
+
+		ExecutePath(path);
+		numAdded += (int) cells.size();
+
+		for (int j=0; j<(int)cells.size(); j++) {
+			if (children2[cells[j]] != -1) {
+				trackStarts.push_back(children2[cells[j]]);
+			}
+		}
+	}
+
+	if (lout.IsVerbose(LogStream::VERBOSITY_SUMMARY)) {
+		lout << "Added " << numAdded << " of " << aNumCells << " cells from the previous tracking result." << endl << endl;
+	}
+	return numAdded;
+}
+
+// Sorting criterion which puts higher scores first.
+static bool HigherScore(const pair<double, Detection*> &aPair1, const pair<double, Detection*> &aPair2) {
+	return aPair1.first > aPair2.first;
+}
+
+// The candidates are ranked by the score of the best path through each detection. The best paths
+// through different detections are often the same. Therefore the detections on paths that have been
+// looked at are not looked at again, regardless of whether the paths were used or not. Most of the
+// remaining paths join tracks that are already used, so only a limited number of paths are looked at.
+// Two paths may not swap the same cell track, as the first swap changes the track that the second
+// one was computed for.
+void CellTrellis::CandidatePaths(list<Arc*> &aBestPath, vector<list<Arc*> > &aPaths,
+	vector<vector<CellNode*> > &aSwapCells) {
+
+	CompleteTables();
+
+	// Detections on the paths that will be added or on rejected paths, and CellNodes that are swapped
+	// by the paths that will be added.
+	set<State*> usedStates;
+	set<CellNode*> usedCells;
+	for (list<Arc*>::iterator lIt = aBestPath.begin(); lIt!=aBestPath.end() ; ++lIt) {
+		usedStates.insert(((Event*) *lIt)->GetEndState());
+		Swap *swap = dynamic_cast<Swap*>(*lIt);
+		if (swap != NULL) {
+			usedCells.insert(swap->GetCell());
+		}
+	}
+
+	// Detections where the best path through them scores above the minimum score, sorted by the score.
+	vector<pair<double, Detection*> > ranked;
+	for (int t=0; t<(int)mDetections.size(); t++) {
+		for (int d=0; d<(int)mDetections[t]->size(); d++) {
+			double score = GetScoreThrough(t+1, d);
+			if (score > mMinScore) {
+				ranked.push_back(pair<double, Detection*>(score, mDetections[t]->at(d)));
+			}
+		}
+	}
+	stable_sort(ranked.begin(), ranked.end(), HigherScore);
+
+	// The number of paths to look at before giving up.
+	int maxExamined = 8 * mBatchSize;
+
+	int examined = 0;
+	for (int i=0; i<(int)ranked.size() && (int)aPaths.size() < mBatchSize-1 && examined < maxExamined; i++) {
+		Detection *detection = ranked[i].second;
+		if (usedStates.count((State*) detection) > 0) {
+			continue;
+		}
+		examined++;
+
+		list<Arc*> path;
+		PathThrough(detection->GetT(), detection->GetIndex(), path);
+
+		bool ok = true;
+		vector<State*> pathStates;
+		vector<CellNode*> pathCells;
+		for (list<Arc*>::iterator lIt = path.begin(); lIt!=path.end() ; ++lIt) {
+			Event *event = (Event*) *lIt;
+			Swap *swap = dynamic_cast<Swap*>(event);
+			if (swap != NULL) {
+				if (usedCells.count(swap->GetCell()) > 0) {
+					ok = false;
+				}
+				pathCells.push_back(swap->GetCell());
+			}
+			if (dynamic_cast<Detection*>(event->GetEndState()) != NULL) {
+				if (usedStates.count(event->GetEndState()) > 0) {
+					ok = false;
+				}
+				pathStates.push_back(event->GetEndState());
+			}
+		}
+
+		usedStates.insert(pathStates.begin(), pathStates.end());
+		if (ok) {
+			aPaths.push_back(path);
+			aSwapCells.push_back(pathCells);
+			usedCells.insert(pathCells.begin(), pathCells.end());
+		}
 	}
 }
 
@@ -377,6 +901,8 @@ void CellTrellis::AddSwaps(CellNode *aCell) {
 	State *endState = aCell->GetState();
 	Event *ev2 = aCell->GetPrevEvent();
 
+	// The tests for the first and the third event are independent, so all combinations of the
+	// events that pass the tests are swaps.
 	vector<Event*> events1;
 	vector<Event*> events3;
 
@@ -389,27 +915,38 @@ void CellTrellis::AddSwaps(CellNode *aCell) {
 				// as the class of the argument to OkSwap12 is never tested.
 			continue;
 		}
-		for (int j=0; j<startState->GetNumForwardArcs(); j++) {
-			Event *ev3 = (Event*) startState->GetForwardArc(j);
-			if (!ev2->OkSwap23(ev3)  || !ev3->OkSwap32(ev2)) {
-				// Avoids score errors when the same event is both removed and added.
-				// Also avoids removing a migration and then trying to add a mitosis
-				// that requires the mitosis to be present. Both tests must be done,
-				// as the class of the argument to OkSwap23 is never tested.
-				continue;
-			}
-			events1.push_back(ev1);
-			events3.push_back(ev3);
+		events1.push_back(ev1);
+	}
+
+	for (int j=0; j<startState->GetNumForwardArcs(); j++) {
+		Event *ev3 = (Event*) startState->GetForwardArc(j);
+		if (!ev2->OkSwap23(ev3)  || !ev3->OkSwap32(ev2)) {
+			// Avoids score errors when the same event is both removed and added.
+			// Also avoids removing a migration and then trying to add a mitosis
+			// that requires the mitosis to be present. Both tests must be done,
+			// as the class of the argument to OkSwap23 is never tested.
+			continue;
 		}
+		events3.push_back(ev3);
+	}
+
+	if (events1.empty() || events3.empty()) {
+		return;
+	}
+
+	if (mLazySwaps) {
+		AddHub(endState->GetT(), new SwapHub(aCell, events1, events3));  // Deleted by aCell.
+		mNumCreatedSwaps++;
+		return;
 	}
 
 	// Add the swaps.
 	for (int i=0; i<(int)events1.size(); i++) {
-		Swap *swap = new Swap(aCell, events1[i], events3[i]);
-		if (aCell->GetState()->GetIndex() == 1 && events1[i]->GetEndState()->GetIndex() == 3) {
-			bool test = 1;
+		for (int j=0; j<(int)events3.size(); j++) {
+			new Swap(aCell, events1[i], events3[j]);  // Deleted by aCell.
 		}
 	}
+	mNumCreatedSwaps += (int) (events1.size() * events3.size());
 }
 
 //void CellTrellis::RemoveSwaps() {
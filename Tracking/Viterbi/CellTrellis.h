@@ -1,12 +1,17 @@
 #ifndef CELLTRELLIS
 #define CELLTRELLIS
 
+#include <list>
+#include <set>
 #include <vector>
+#include "Arena.h"
 #include "IdleState.h"
 #include "Trellis.h"
 
+class Arc;
 class CellNode;
 class Detection;
+class ScoreMatrix;
 class Swap;
 class Tree;
 
@@ -29,6 +34,27 @@ using namespace std;
 // images in the image sequence, because there is a start state and an end state. This means that
 // mNumT is aNumT+2. In the future, we might combine the born-later states and the dead states
 // into idle-states.
+//
+// In batch mode, AddCell can add multiple cells per search. After the highest scoring path has been
+// found, the highest scoring paths through the other detections are taken as candidates, in order of
+// decreasing score. Candidates that share detections or swapped cell tracks with the best path or
+// with previously selected candidates are skipped. The candidates are executed after the best path,
+// one by one, if their swaps have not been removed by the paths executed before them and their scores
+// are still above the minimum score when they are recomputed for the current tree. This is how swaps
+// and mitosis events, which depend on the cells in the tree, are handled. Only a limited number of
+// candidates is examined, and many of them join tracks that are already used, so the number of
+// searches usually goes down much less than the batch size. The result is not always the same as when the cells are added one at a time.
+//
+// In lazy swap mode, the swaps of a CellNode are not created as arcs. Instead, a SwapHub represents
+// all combinations of first and second events of the swaps, and a Swap is only created when it is on
+// a path returned by the Trellis. This reduces the memory and the time used for swaps from the product
+// of the numbers of first and second events to their sum. The highest scoring path has the same score
+// as without lazy swaps, but the summation order of the swap scores is different, and the swaps are
+// considered after the other arcs, so paths with equal scores can be chosen differently.
+//
+// The CellNodes and the Events, including the Swaps that are replaced in every iteration, are allocated
+// from an Arena owned by the CellTrellis. The functions that create or delete such objects make the
+// Arena current while they run.
 
 class CellTrellis : public Trellis {
     
@@ -66,21 +92,90 @@ public:
 	// and s1 is the score of appearance.
 	// aDisappearA - Disappearance scores. The second dimension is [t d1 s0 s1], where s0 is the score of no disappearance
 	// and s1 is the score of disappearance.
+	// aNumThreads - The number of threads used to create the events and to process the layers of the trellis.
+	// See Trellis::SetNumThreads.
 	CellTrellis(bool aSingleIdleState, int aNumT, int aMaxCount, int aNumMigs, int aNumMits, int aNumApos, int aNumAppear, int aNumDisappear,
-	double *aNumTDets, double *aCountA, double *aMigA, double *aMitA, double *aApoA, double *aAppearA, double *aDisappearA, double aMaxMigScore);
+	double *aNumTDets, double *aCountA, double *aMigA, double *aMitA, double *aApoA, double *aAppearA, double *aDisappearA, double aMaxMigScore,
+	int aNumThreads = 1);
+
+	// Creates a trellis from inputs where the columns can have other types than double. The
+	// matrices have the same columns as the corresponding double arrays above, and the numbers of
+	// events are the numbers of rows in the matrices. The matrices are not used after the trellis
+	// has been created.
+	CellTrellis(bool aSingleIdleState, int aNumT, int aMaxCount, const double *aNumTDets, const ScoreMatrix &aCount,
+	const ScoreMatrix &aMig, const ScoreMatrix &aMit, const ScoreMatrix &aApo, const ScoreMatrix &aAppear,
+	const ScoreMatrix &aDisappear, double aMaxMigScore, int aNumThreads = 1);
 
 	virtual ~CellTrellis();
 
 	// Adds a cell to the lineage tree in an optimal way, if that increases the score of the lineage
-	// Tree. The method returns 1 if a cell was added and 0 otherwise. The tracking problem is solved
-	// by calling this function until it returns 0.
+	// Tree. In batch mode, more cells can be added. The method returns the number of cells that
+	// were added. The tracking problem is solved by calling this function until it returns 0.
 	int AddCell();
     
+	// Returns the sum of the scores of the paths that were executed in the last call to AddCell.
+	double GetAddedScore() const { return mAddedScore; }
+
+	// Returns the total number of swaps that have been created. In lazy swap mode, a SwapHub is
+	// counted as a single swap.
+	int GetNumCreatedSwaps() const { return mNumCreatedSwaps; }
+
+	// Returns the total number of swaps that have been deleted, counted as in GetNumCreatedSwaps.
+	int GetNumDeletedSwaps() const { return mNumDeletedSwaps; }
+
+	// Returns the time in seconds that the last call to AddCell spent searching for the highest
+	// scoring path.
+	double GetSearchTime() const { return mSearchTime; }
+
 	// Returns a pointer to the Tree that AddCell has added cell to.
 	Tree *GetTree() { return mTree; }
 
+	// Prints the number of arcs of each type and the number of bytes that they use, followed by
+	// the memory used by the arc lists of the nodes, by the Count objects and their scores, and
+	// the memory reserved by the Arenas. The sizes of the arcs include the Arena headers, but not
+	// the memory of vectors inside the arcs, such as the entries and exits of hubs.
+	void PrintMemory();
+
+	// Sets the maximum number of cells that AddCell can add from a single search. The default
+	// is 1, which means that batch mode is turned off.
+	void SetBatchSize(int aBatchSize) { mBatchSize = aBatchSize; }
+
+	// If aLazySwaps is true, the swaps of new CellNodes are represented by SwapHubs instead of Swap
+	// arcs. Swaps that are already in the trellis are not affected.
+	void SetLazySwaps(bool aLazySwaps) { mLazySwaps = aLazySwaps; }
+
+	// Sets the score that a path must exceed to be executed by AddCell. The default is 0, which
+	// means that cells are added as long as they increase the score of the Tree. Larger values
+	// stop the tracking earlier, when the remaining cells only give small improvements.
+	void SetMinScore(double aMinScore) { mMinScore = aMinScore; }
+
+	// Adds the cells of a previous tracking result to the Tree, so that AddCell continues from that
+	// result instead of from an empty Tree. The inputs have the same format as the outputs of
+	// Tree::GetCells, with aNumCells cells. A cell and the first daughter cells that continue its track
+	// are added as one path through the trellis, and second daughter cells are added with Mitosis
+	// events after their parents. Tracks with events that are not in the trellis, for example because
+	// the scores have been computed with different settings, are left out together with their daughter
+	// cells. Returns the number of cells that were added.
+	int WarmStart(int aNumCells, const double *aCellA, const double *aDivA, const double *aDeathA);
+
 private:
 	bool mSingleIdleState;
+	int mBatchSize;		// The maximum number of cells that can be added in a call to AddCell.
+	bool mLazySwaps;	// True if swaps are represented by SwapHubs.
+	double mMinScore;	// The score that a path must exceed to be executed.
+
+	// Statistics that can be used to follow the progress of the tracking.
+	double mAddedScore;		// The score added in the last call to AddCell.
+	double mSearchTime;		// The time of the last search for the highest scoring path.
+	int mNumCreatedSwaps;
+	int mNumDeletedSwaps;
+
+	// Memory for CellNodes and Events. Can not be a member object, because it has to be
+	// destroyed after the nodes, which are deleted in the destructor.
+	Arena *mArena;
+
+	// Arenas that the events are allocated from when they are created on multiple threads.
+	vector<Arena*> mBuildArenas;
 
 	// The lineage tree that keeps track of previously added cells. Can not be a
 	// member object, because the Tree has to be destoyed before the States.
@@ -113,6 +208,21 @@ private:
 
 	void AddSwaps(CellNode *aCell);
 
+	// Finds paths that can be added together with aBestPath in batch mode and writes them into
+	// aPaths, in the order that they should be added. aBestPath has not been executed yet. The
+	// CellNodes of the swaps on each path are written into aSwapCells.
+	void CandidatePaths(list<Arc*> &aBestPath, vector<list<Arc*> > &aPaths, vector<vector<CellNode*> > &aSwapCells);
+
+	// Adds the events on aPath to the tree and replaces the swaps of the new cells. If aChangedCells
+	// is not NULL, the CellNodes whose swaps were replaced are inserted into it.
+	void ExecutePath(list<Arc*> &aPath, set<CellNode*> *aChangedCells = NULL);
+
+	// Returns the idle state that cells which are born later are in, in the zero-based image aT.
+	IdleState *GetBornLaterState(int aT) { return mSingleIdleState ? mIdleStates[aT] : mBornLaterStates[aT]; }
+
+	// Returns the idle state that dead cells are in, in the zero-based image aT.
+	IdleState *GetDeadState(int aT) { return mSingleIdleState ? mIdleStates[aT] : mDeadStates[aT]; }
+
 	//// Adds new swap events to the CellTrellis.
 	//void AddSwaps();
 
@@ -0,0 +1,267 @@
+#include "ComponentLinker.h"
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "CellTrellis.h"
+#include "LogStream.h"
+#include "ScoreMatrix.h"
+#include "ThreadPool.h"
+#include "Tree.h"
+
+using namespace std;
+
+// Returns the representative of the set that element aI belongs to, in a union-find structure
+// where aParents holds the parent of every element. Halves the paths that are traversed.
+static int Find(vector<int> &aParents, int aI) {
+	while (aParents[aI] != aI) {
+		aParents[aI] = aParents[aParents[aI]];
+		aI = aParents[aI];
+	}
+	return aI;
+}
+
+// Merges the sets that elements aI and aJ belong to.
+static void Union(vector<int> &aParents, int aI, int aJ) {
+	int rootI = Find(aParents, aI);
+	int rootJ = Find(aParents, aJ);
+	if (rootI != rootJ) {
+		aParents[max(rootI, rootJ)] = min(rootI, rootJ);
+	}
+}
+
+// Appends the indices of the rows of aA to the row lists aPartRows[p][aMatrix] of the parts that the
+// detections in the second column belong to.
+static void AssignRows(const ScoreMatrix &aA, const vector<int> &aDetOffsets, const vector<int> &aDetParts,
+	int aMatrix, vector<vector<vector<int> > > &aPartRows) {
+
+		for (int i=0; i<aA.GetNumRows(); i++) {
+			int det = aDetOffsets[aA.GetInt(i, 0) - 1] + aA.GetInt(i, 1) - 1;
+			aPartRows[aDetParts[det]][aMatrix].push_back(i);
+		}
+}
+
+// Copies the rows aRows of aA into the column-major double matrix aSelected, and returns the number
+// of rows. The aNumCurrent columns after
+// the image number hold detection indices in the image of the row, and the next aNumNext columns hold
+// detection indices in the next image. These are replaced by the indices aLocalIndices, which the
+// detections have in the part.
+static int SelectRows(const ScoreMatrix &aA, const vector<int> &aRows, int aNumCurrent, int aNumNext,
+	const vector<int> &aDetOffsets, const vector<int> &aLocalIndices, vector<double> &aSelected) {
+
+		int numSelected = (int) aRows.size();
+		aA.SelectRows(aRows, aSelected);
+		for (int i=0; i<numSelected; i++) {
+			int t = aA.GetInt(aRows[i], 0) - 1;
+			for (int j=1; j<=aNumCurrent+aNumNext; j++) {
+				int det = aDetOffsets[j <= aNumCurrent ? t : t+1] + aA.GetInt(aRows[i], j) - 1;
+				aSelected[j*numSelected+i] = aLocalIndices[det] + 1.0;
+			}
+		}
+		return numSelected;
+}
+
+ComponentLinker::ComponentLinker(bool aSingleIdleState, int aNumT, int aMaxCount, const double *aNumTDets,
+	const ScoreMatrix &aCount, const ScoreMatrix &aMig, const ScoreMatrix &aMit, const ScoreMatrix &aApo,
+	const ScoreMatrix &aAppear, const ScoreMatrix &aDisappear, double aMaxMigScore, int aNumThreads)
+	: mSingleIdleState(aSingleIdleState), mNumT(aNumT), mMaxCount(aMaxCount), mNumTDets(aNumTDets), mCount(aCount),
+	mMig(aMig), mMit(aMit), mApo(aApo), mAppear(aAppear), mDisappear(aDisappear), mMaxMigScore(aMaxMigScore),
+	mNumThreads(aNumThreads), mBatchSize(1), mLazySwaps(false), mMinScore(0), mWindowed(false), mNumComponents(0) {
+}
+
+void ComponentLinker::GetCells(double *aCellA, double *aDivA, double *aDeathA) {
+	int numCells = GetNumCells();
+	int first = 0;  // Index of the first cell of the current part.
+	for (int p=0; p<(int)mPartNumCells.size(); p++) {
+		int n = mPartNumCells[p];
+		for (int c=0; c<n; c++) {
+			for (int t=0; t<mNumT; t++) {
+				int local = (int) mPartCellA[p][c*mNumT+t];
+				if (local == 0) {
+					aCellA[(first+c)*mNumT+t] = 0.0;
+				} else {
+					int det = mPartDets[p][mPartOffsets[p][t] + local - 1];
+					aCellA[(first+c)*mNumT+t] = det - mDetOffsets[t] + 1.0;
+				}
+			}
+			for (int i=0; i<2; i++) {
+				double child = mPartDivA[p][i*n+c];
+				aDivA[i*numCells+first+c] = (child == 0.0) ? 0.0 : child + first;
+			}
+			aDeathA[first+c] = mPartDeathA[p][c];
+		}
+		first += n;
+	}
+}
+
+int ComponentLinker::GetNumCells() const {
+	int numCells = 0;
+	for (int p=0; p<(int)mPartNumCells.size(); p++) {
+		numCells += mPartNumCells[p];
+	}
+	return numCells;
+}
+
+void ComponentLinker::Link() {
+	mDetOffsets.assign(mNumT+1, 0);
+	for (int t=0; t<mNumT; t++) {
+		mDetOffsets[t+1] = mDetOffsets[t] + (int) mNumTDets[t];
+	}
+	int numDets = mDetOffsets[mNumT];
+
+	// Join the detections that are linked by migrations or mitoses.
+	vector<int> parents(numDets);
+	for (int i=0; i<numDets; i++) {
+		parents[i] = i;
+	}
+	for (int i=0; i<mMig.GetNumRows(); i++) {
+		int t = mMig.GetInt(i, 0) - 1;
+		Union(parents, mDetOffsets[t] + mMig.GetInt(i, 1) - 1, mDetOffsets[t+1] + mMig.GetInt(i, 2) - 1);
+	}
+	for (int i=0; i<mMit.GetNumRows(); i++) {
+		int t = mMit.GetInt(i, 0) - 1;
+		int parent = mDetOffsets[t] + mMit.GetInt(i, 1) - 1;
+		Union(parents, parent, mDetOffsets[t+1] + mMit.GetInt(i, 2) - 1);
+		Union(parents, parent, mDetOffsets[t+1] + mMit.GetInt(i, 3) - 1);
+	}
+
+	// Number the components in the order of their first detections.
+	vector<int> components(numDets, -1);
+	vector<int> componentSizes;
+	for (int i=0; i<numDets; i++) {
+		int root = Find(parents, i);
+		if (components[root] == -1) {
+			components[root] = (int) componentSizes.size();
+			componentSizes.push_back(0);
+		}
+		componentSizes[components[root]]++;
+	}
+	mNumComponents = (int) componentSizes.size();
+
+	// Group consecutive components into parts with at least mNumT detections.
+	vector<int> componentParts(mNumComponents);
+	int numParts = 0;
+	int partSize = 0;
+	for (int c=0; c<mNumComponents; c++) {
+		componentParts[c] = numParts;
+		partSize += componentSizes[c];
+		if (partSize >= mNumT) {
+			numParts++;
+			partSize = 0;
+		}
+	}
+	if (partSize > 0) {
+		numParts++;
+	}
+
+	// Detections of the parts, and the indices that they have in their images in the parts.
+	mPartDets.assign(numParts, vector<int>());
+	mPartOffsets.assign(numParts, vector<int>(mNumT+1, 0));
+	vector<int> detParts(numDets);
+	vector<int> localIndices(numDets);
+	for (int t=0; t<mNumT; t++) {
+		for (int p=0; p<numParts; p++) {
+			mPartOffsets[p][t] = (int) mPartDets[p].size();
+		}
+		for (int i=mDetOffsets[t]; i<mDetOffsets[t+1]; i++) {
+			int p = componentParts[components[Find(parents, i)]];
+			detParts[i] = p;
+			localIndices[i] = (int) mPartDets[p].size() - mPartOffsets[p][t];
+			mPartDets[p].push_back(i);
+		}
+	}
+	for (int p=0; p<numParts; p++) {
+		mPartOffsets[p][mNumT] = (int) mPartDets[p].size();
+	}
+
+	// Rows of the count, migration, mitosis, apoptosis, appearance and disappearance matrices of the parts.
+	vector<vector<vector<int> > > partRows(numParts, vector<vector<int> >(6));
+	AssignRows(mCount, mDetOffsets, detParts, 0, partRows);
+	AssignRows(mMig, mDetOffsets, detParts, 1, partRows);
+	AssignRows(mMit, mDetOffsets, detParts, 2, partRows);
+	AssignRows(mApo, mDetOffsets, detParts, 3, partRows);
+	AssignRows(mAppear, mDetOffsets, detParts, 4, partRows);
+	AssignRows(mDisappear, mDetOffsets, detParts, 5, partRows);
+
+	// The largest parts are started first, to balance the work between the threads.
+	vector<pair<int, int> > order;
+	for (int p=0; p<numParts; p++) {
+		order.push_back(make_pair(-(int) mPartDets[p].size(), p));
+	}
+	sort(order.begin(), order.end());
+
+	mPartNumCells.assign(numParts, 0);
+	mPartCellA.assign(numParts, vector<double>());
+	mPartDivA.assign(numParts, vector<double>());
+	mPartDeathA.assign(numParts, vector<double>());
+	vector<string> logs(numParts);
+	int verbosity = lout.GetVerbosity();  // The threads have separate LogStreams.
+	function<void(int, int)> linkParts = [&](int aBegin, int aEnd) {
+		lout.SetVerbosity(verbosity);
+		for (int i=aBegin; i<aEnd; i++) {
+			int p = order[i].second;
+			lout.StartCapture();
+			LinkPart(p, localIndices, partRows[p]);
+			logs[p] = lout.EndCapture();
+		}
+	};
+	if (mNumThreads == 1) {
+		linkParts(0, numParts);
+	} else {
+		ThreadPool threadPool(mNumThreads);
+		threadPool.ParallelFor(numParts, 1, linkParts);
+	}
+
+	if (lout.IsVerbose(LogStream::VERBOSITY_SUMMARY)) {
+		lout << "The detections form " << mNumComponents << " components, which were linked in "
+			<< numParts << " parts." << endl << endl;
+	}
+	for (int p=0; p<numParts; p++) {
+		if (!logs[p].empty()) {
+			lout << "Part " << p+1 << ":" << endl << logs[p] << flush;
+		}
+	}
+}
+
+void ComponentLinker::LinkPart(int aPart, const vector<int> &aLocalIndices, const vector<vector<int> > &aRows) {
+	vector<double> numTDets(mNumT);
+	for (int t=0; t<mNumT; t++) {
+		numTDets[t] = mPartOffsets[aPart][t+1] - mPartOffsets[aPart][t];
+	}
+
+	vector<double> countA, migA, mitA, apoA, appearA, disappearA;
+	SelectRows(mCount, aRows[0], 1, 0, mDetOffsets, aLocalIndices, countA);
+	int numMigs = SelectRows(mMig, aRows[1], 1, 1, mDetOffsets, aLocalIndices, migA);
+	int numMits = SelectRows(mMit, aRows[2], 1, 2, mDetOffsets, aLocalIndices, mitA);
+	int numApos = SelectRows(mApo, aRows[3], 1, 0, mDetOffsets, aLocalIndices, apoA);
+	int numAppear = SelectRows(mAppear, aRows[4], 1, 0, mDetOffsets, aLocalIndices, appearA);
+	int numDisappear = SelectRows(mDisappear, aRows[5], 1, 0, mDetOffsets, aLocalIndices, disappearA);
+
+	CellTrellis cellTrellis(mSingleIdleState, mNumT, mMaxCount, numMigs, numMits, numApos, numAppear, numDisappear,
+		&numTDets[0], &countA[0], &migA[0], &mitA[0], &apoA[0], &appearA[0], &disappearA[0], mMaxMigScore);
+	cellTrellis.SetWindowed(mWindowed);
+	cellTrellis.SetBatchSize(mBatchSize);
+	cellTrellis.SetLazySwaps(mLazySwaps);
+	cellTrellis.SetMinScore(mMinScore);
+
+	Tree *tree = cellTrellis.GetTree();
+	int iter = 1;
+	while (true) {
+		tree->SetIteration(iter);
+		if (lout.IsVerbose(LogStream::VERBOSITY_ITERATIONS)) {
+			lout << "Iteration " << iter << endl;
+		}
+		if (cellTrellis.AddCell() == 0) {
+			break;
+		}
+		iter++;
+	}
+
+	int numCells = tree->GetNumCells();
+	mPartNumCells[aPart] = numCells;
+	mPartCellA[aPart].resize(max(mNumT*numCells, 1));
+	mPartDivA[aPart].resize(max(2*numCells, 1));
+	mPartDeathA[aPart].resize(max(numCells, 1));
+	tree->GetCells(&mPartCellA[aPart][0], &mPartDivA[aPart][0], &mPartDeathA[aPart][0]);
+}
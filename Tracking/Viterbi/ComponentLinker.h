@@ -0,0 +1,102 @@
+#ifndef COMPONENTLINKER
+#define COMPONENTLINKER
+
+#include <vector>
+#include "ScoreMatrix.h"
+
+using namespace std;
+
+// Track linking where the tracking problem is split into independent parts that are solved in
+// parallel. Two detections are in the same connected component if they are linked by a chain of
+// migration and mitosis events. Cells can not move between components, so the components can be
+// linked in separate CellTrellis objects, and the cell tracks of the components are put together
+// afterwards. Small components are grouped into parts with at least as many detections as there
+// are images, so that the idle states of the trellises do not dominate the work. The parts are
+// linked on multiple threads, starting with the largest ones. The outputs of each part are captured
+// and printed when all parts are done, in the order of the parts.
+//
+// With separate idle states for appearing and dead cells, the result is usually the same as when all
+// detections are linked in a single CellTrellis, apart from the order of the cells and the choice
+// between paths with equal scores. It is not always the same, because the greedy choices can differ.
+// In a single CellTrellis, a swap can break an appearance in one component and let the cell appear
+// in another component instead. A single path can then lower the score in one component and raise
+// it in another, and such paths can not be found when the components are linked separately. With a
+// single idle state, a cell can disappear from one component and appear in another, and such cells
+// are split into two cells.
+class ComponentLinker {
+public:
+	// Creates a linker for the tracking problem defined by the inputs, which are the same as the
+	// inputs of the CellTrellis constructor that takes ScoreMatrix objects. The input arrays are not
+	// copied and must exist until Link has been called, but Link copies the rows of each part into
+	// double matrices, so the inputs are converted to doubles one part at a time. aNumThreads is the
+	// number of threads that the parts are linked on.
+	ComponentLinker(bool aSingleIdleState, int aNumT, int aMaxCount, const double *aNumTDets,
+		const ScoreMatrix &aCount, const ScoreMatrix &aMig, const ScoreMatrix &aMit, const ScoreMatrix &aApo,
+		const ScoreMatrix &aAppear, const ScoreMatrix &aDisappear, double aMaxMigScore, int aNumThreads = 1);
+
+	// Writes the cell tracks into matrices with the same format as the outputs of Tree::GetCells. The
+	// matrices must have room for the images and GetNumCells() cells.
+	void GetCells(double *aCellA, double *aDivA, double *aDeathA);
+
+	// Returns the number of connected components found by Link.
+	int GetNumComponents() const { return mNumComponents; }
+
+	// Returns the number of cells in the tracks.
+	int GetNumCells() const;
+
+	// Finds the components, groups them into parts and links the parts.
+	void Link();
+
+	// Sets the batch size of the CellTrellis objects. See CellTrellis::SetBatchSize.
+	void SetBatchSize(int aBatchSize) { mBatchSize = aBatchSize; }
+
+	// Turns lazy swaps on or off in the CellTrellis objects. See CellTrellis::SetLazySwaps.
+	void SetLazySwaps(bool aLazySwaps) { mLazySwaps = aLazySwaps; }
+
+	// Sets the minimum path score of the CellTrellis objects. See CellTrellis::SetMinScore.
+	void SetMinScore(double aMinScore) { mMinScore = aMinScore; }
+
+	// Turns windowed search on or off in the CellTrellis objects. See Trellis::SetWindowed.
+	void SetWindowed(bool aWindowed) { mWindowed = aWindowed; }
+
+private:
+	bool mSingleIdleState;
+	int mNumT;
+	int mMaxCount;
+	const double *mNumTDets;
+	ScoreMatrix mCount;
+	ScoreMatrix mMig;
+	ScoreMatrix mMit;
+	ScoreMatrix mApo;
+	ScoreMatrix mAppear;
+	ScoreMatrix mDisappear;
+	double mMaxMigScore;
+	int mNumThreads;
+	int mBatchSize;
+	bool mLazySwaps;
+	double mMinScore;
+	bool mWindowed;
+
+	int mNumComponents;
+
+	// Index of the first detection of every image, in a numbering of all detections in the sequence.
+	vector<int> mDetOffsets;
+
+	// The detections of each part, in the numbering of all detections, ordered by image and detection
+	// index. The detections of image t are mPartDets[p][mPartOffsets[p][t]] to
+	// mPartDets[p][mPartOffsets[p][t+1]-1].
+	vector<vector<int> > mPartDets;
+	vector<vector<int> > mPartOffsets;
+
+	// The outputs of Tree::GetCells for each part.
+	vector<int> mPartNumCells;
+	vector<vector<double> > mPartCellA;
+	vector<vector<double> > mPartDivA;
+	vector<vector<double> > mPartDeathA;
+
+	// Creates a CellTrellis for part aPart, links it and stores the result. aLocalIndices are the
+	// indices of the detections within their images in the parts, and aRows are the rows of the
+	// count, migration, mitosis, apoptosis, appearance and disappearance matrices in the part.
+	void LinkPart(int aPart, const vector<int> &aLocalIndices, const vector<vector<int> > &aRows);
+};
+#endif
@@ -1,6 +1,8 @@
 #ifndef COUNT
 #define COUNT
 
+#include <cstddef>  // To get size_t.
+#include "Arena.h"
 #include "Variable.h"
 
 // Event that keeps track of the number of cells in a detection
@@ -12,5 +14,9 @@ public:
 	// Stores the cell count, the scores associated with different cell counts and the number of scores.
 	// The number of scores is equal to the maximum cell count minus 1.
 	Count(int aValue, int aNumScores, const double *aScores);
+
+	// Counts are allocated from the current Arena, like the Events.
+	static void *operator new(size_t aSize) { return Arena::Allocate(aSize); }
+	static void operator delete(void *aPointer, size_t aSize) { Arena::Free(aPointer, aSize); }
 };
 #endif
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "Detection.h"
+#include <algorithm>
 #include <cstddef>  // To get NULL.
+#include <utility>
 #include <vector>
 #include "CellNode.h"
 #include "Count.h"
@@ -18,8 +20,8 @@ Detection::~Detection() {
 
 	// Destroy the mitosis events that are not in the Trellis. The ones in the Trellis are destoyed
 	// when the Trellis Nodes are destroyed.
-	for (MitosisIterator mitIt=mMitosisMap.begin(); mitIt!=mMitosisMap.end(); ++mitIt) {
-		Mitosis *mit = mitIt->second;
+	for (int i=0; i<(int)mMitoses.size(); i++) {
+		Mitosis *mit = mMitoses[i];
 		if (!mit->IsInTrellis()) {
 			delete mit;
 		}
@@ -27,26 +29,49 @@ Detection::~Detection() {
 }
 
 void Detection::AddMigration(Migration *aMigration) {
-	mMigrationMap[(Detection*) aMigration->GetEndState()] = aMigration;
+	int key = aMigration->GetEndState()->GetIndex();
+	vector<int>::iterator it = lower_bound(mMigrationKeys.begin(), mMigrationKeys.end(), key);
+	int pos = (int) (it - mMigrationKeys.begin());
+	if (it != mMigrationKeys.end() && *it == key) {
+		mMigrations[pos] = aMigration;
+	} else {
+		mMigrationKeys.insert(it, key);
+		mMigrations.insert(mMigrations.begin() + pos, aMigration);
+	}
 }
 
+// The mitosis is inserted after the mitosis events with the same key.
 void Detection::AddMitosis(Mitosis *aMitosis) {
-	mMitosisMap.insert(pair<Detection*,Mitosis*>(aMitosis->GetOtherChild(), aMitosis));
+	int key = aMitosis->GetOtherChild()->GetIndex();
+	vector<int>::iterator it = upper_bound(mMitosisKeys.begin(), mMitosisKeys.end(), key);
+	int pos = (int) (it - mMitosisKeys.begin());
+	mMitosisKeys.insert(it, key);
+	mMitoses.insert(mMitoses.begin() + pos, aMitosis);
+}
+
+void Detection::ReserveEvents(int aNumMigrations, int aNumMitoses) {
+	mMigrationKeys.reserve(mMigrationKeys.size() + aNumMigrations);
+	mMigrations.reserve(mMigrations.size() + aNumMigrations);
+	mMitosisKeys.reserve(mMitosisKeys.size() + aNumMitoses);
+	mMitoses.reserve(mMitoses.size() + aNumMitoses);
 }
 
 Migration *Detection::GetMigration(Detection *aDetection) {
-	map<Detection*, Migration*>::iterator it = mMigrationMap.find(aDetection);
-	if (it!=mMigrationMap.end()) {
-		return it->second;
+	int key = aDetection->GetIndex();
+	vector<int>::iterator it = lower_bound(mMigrationKeys.begin(), mMigrationKeys.end(), key);
+	if (it != mMigrationKeys.end() && *it == key) {
+		return mMigrations[it - mMigrationKeys.begin()];
 	} else {
 		return NULL;
 	}
 }
 
 void Detection::GetMitosis(Detection *aDetection, MitosisIterator &aFirst, MitosisIterator &aLast) {
-	pair<MitosisIterator, MitosisIterator> mitInterval = mMitosisMap.equal_range(aDetection);
-	aFirst = mitInterval.first;
-	aLast = mitInterval.second;
+	int key = aDetection->GetIndex();
+	pair<vector<int>::iterator, vector<int>::iterator> keyInterval =
+		equal_range(mMitosisKeys.begin(), mMitosisKeys.end(), key);
+	aFirst = mMitoses.begin() + (keyInterval.first - mMitosisKeys.begin());
+	aLast = mMitoses.begin() + (keyInterval.second - mMitosisKeys.begin());
 }
 
 double Detection::GetMinusScore() {
@@ -59,8 +84,10 @@ double Detection::GetPlusScore() {
 
 void Detection::Minus() {
 	mCount->Minus();
+	SetChanged();
 }
 
 void Detection::Plus() {
 	mCount->Plus();
+	SetChanged();
 }
@@ -1,7 +1,7 @@
 #ifndef DETECTION
 #define DETECTION
 
-#include <map>
+#include <vector>
 #include "State.h"
 
 class Count;
@@ -13,9 +13,14 @@ using namespace std;
 // Detections are states associated with detected pixel regions that could contain cells.
 // The detection keeps track of what cells pass through and has a Count object that keeps
 // track of how the count score of the detection changes when cells are added or removed.
+//
+// The migrations and mitosis events that start in the detection are stored in flat arrays, sorted by
+// the index of the end detection of the migration and the index of the other child of the mitosis.
+// All of these detections are in the next image, so the indices are unique. The events are usually
+// created in order, so that they can be appended to the arrays, but they can be added in any order.
 class Detection: public State {
 public:
-	typedef multimap<Detection*, Mitosis*>::iterator MitosisIterator;
+	typedef vector<Mitosis*>::iterator MitosisIterator;
 
 	// Creates a detection object in image aT, with index aIndex. The states
 	// in image t are supposed to be numbered from 0 to Mt-1, where Mt is the
@@ -30,12 +35,18 @@ public:
 
 	// Add a migration event to the detection. This does not imply that the migration takes
 	// place, but that cells are allowed to perform the migration in the tracking problem.
-	// The migrations are stored in a map where they can be accessed with the end Detection
-	// as a key. This is done to make Mitosis events easier to create.
+	// The migrations are stored so that they can be accessed with the end Detection as a key.
+	// This is done to make Mitosis events easier to create. If there already is a migration
+	// to the same Detection, it is replaced.
 	void AddMigration(Migration *aMigration);
 
+	// Adds a mitosis event where the parent cell is in the current detection. Mitosis events with
+	// the same other child are kept in the order that they were added in.
 	void AddMitosis(Mitosis *aMitosis);
 
+	// Allocates space for aNumMigrations more migrations and aNumMitoses more mitosis events.
+	void ReserveEvents(int aNumMigrations, int aNumMitoses);
+
 	// Returns a migration that starts in the current Detection and ends in aDetection,
 	// if such a migration exists. If no such migration exists, the function returns NULL.
 	Migration *GetMigration(Detection *aDetection);
@@ -43,6 +54,7 @@ public:
 	// Score associated with removing a CellNode from the Detection.
 	virtual double GetMinusScore();
 
+	// Returns the interval [aFirst, aLast) of mitosis events where aDetection is the other child.
 	void GetMitosis(Detection *aDetection, MitosisIterator &aFirst, MitosisIterator &aLast);
 
 	// Score associated with adding a CellNode to the Detection.
@@ -58,6 +70,9 @@ public:
 	// one cell count event.
     void SetCount(Count *aCount) { mCount = aCount; }
 
+	// Returns the cell count event of the detection, or NULL if it has none.
+	Count *GetCount() { return mCount; }
+
 private:
 
 	// Specifies the cell count and the score assoicated with it.
@@ -65,10 +80,14 @@ private:
 	// its destructor.
 	Count *mCount;
 
-	// All of the migrations that start in the current detection, stored in a map
-	// where the migration end detections are used as keys.
-	map<Detection*, Migration*> mMigrationMap;
+	// All of the migrations that start in the current detection, sorted by the indices of the
+	// end detections, which are stored in mMigrationKeys.
+	vector<int> mMigrationKeys;
+	vector<Migration*> mMigrations;
 
-	multimap<Detection*, Mitosis*> mMitosisMap;
+	// All of the mitosis events where the parent cell is in the current detection, sorted by the
+	// indices of the other children, which are stored in mMitosisKeys.
+	vector<int> mMitosisKeys;
+	vector<Mitosis*> mMitoses;
 };
 #endif
\ No newline at end of file
@@ -28,7 +28,7 @@ void Disappearance::Execute(Tree *aTree, vector<CellNode*> *aEndCellNodes, bool
 
 void Disappearance::Execute(Tree *aTree, vector<CellNode*> *aEndCellNodes, CellNode *aCell) {
 	CellNode *activeCell = aTree->GetActiveCell();
-	activeCell->AddLink(this, aCell);
+	activeCell->AddLink(aTree, this, aCell);
 	aTree->SetActiveCell(NULL);
 
 	aEndCellNodes->push_back(aCell);
@@ -37,5 +37,8 @@ public:
 
 	// Returns the score associated with adding the disappearance event to a tree.
 	virtual double GetScore() const;
+
+	// The score only depends on the disappearance counter.
+	virtual bool HasLocalScore() const { return true; }
 };
 #endif
\ No newline at end of file
@@ -15,6 +15,14 @@ Event::Event(State *aStartState, State *aEndState)
 		mEndState = aEndState;
 }
 
+Event::Event(State *aStartState, State *aEndState, bool aAddToNodes) 
+	: Arc((Node*) aStartState, (Node*) aEndState, aAddToNodes),
+	Variable() {
+		 
+		mStartState = aStartState;
+		mEndState = aEndState;
+}
+
 Event::Event(State *aStartState, State *aEndState, int aValue, int aNumScores, const double *aScores) 
 	: Arc((Node*) aStartState, (Node*) aEndState),
 	Variable(aValue, aNumScores, aScores) {
@@ -72,4 +80,15 @@ bool Event::OkSwap32(Event *aEvent) {
 	} else {
 		return true;
 	}
-}
\ No newline at end of file
+}
+// All arcs that depend on the Variable end in the same layer as the Event.
+void Event::Plus() {
+	Variable::Plus();
+	mEndState->SetChanged();
+}
+
+// All arcs that depend on the Variable end in the same layer as the Event.
+void Event::Minus() {
+	Variable::Minus();
+	mEndState->SetChanged();
+}
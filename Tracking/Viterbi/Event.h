@@ -25,6 +25,10 @@ public:
 	// aEndState - The state that the event links to.
 	Event(State *aStartState, State *aEndState);
 
+	// Creates an Event that has no score associated with it, and that is only added to the
+	// arc lists of the states if aAddToNodes is true. See Arc.
+	Event(State *aStartState, State *aEndState, bool aAddToNodes);
+
 	// Creates an Event that has different scores associated different occurrance counts.
 	// 
 	// Inputs:
@@ -49,6 +53,16 @@ public:
 	 // aCell - CellNode associated with aEndState.
 	 virtual void Execute(Tree *aTree, vector<CellNode*> *aEndCellNodes, CellNode *aCell) = 0;
 
+	// Scores that are not stored in the object may have been taken from the heap.
+	virtual bool OwnsHeapMemory() const { return GetNumScoreBytes() > 0; }
+
+	// Called by CellNode when aCell is linked to the next CellNode in its cell track using the Event.
+	// Does nothing by default, but sub-classes can keep track of the CellNodes that use them.
+	virtual void AddCell(CellNode *aCell) {}
+
+	// Called by CellNode when the link from aCell to the next CellNode is removed.
+	virtual void RemoveCell(CellNode *aCell) {}
+
 	State *GetEndState() { return mEndState; }
 
 	State *GetStartState() { return mStartState; }
@@ -74,6 +88,14 @@ public:
 
 	virtual bool OkSwap32(Event *aEvent);
 
+	// Increases the value by 1 and tells the Trellis that the scores of arcs ending in
+	// mEndState may have changed.
+	virtual void Plus();
+
+	// Decreases the value by 1 and tells the Trellis that the scores of arcs ending in
+	// mEndState may have changed.
+	virtual void Minus();
+
 protected:
 	State *mEndState;		// The state linked to by the Event.
 	State *mStartState;		// The state linked from by the Event.
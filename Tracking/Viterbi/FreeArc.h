@@ -35,5 +35,8 @@ public:
 
 	// The score associated with traversing the FreeArc is 0.0.
 	virtual double GetScore() const { return 0.0; }
+
+	// The score is constant.
+	virtual bool HasLocalScore() const { return true; }
 };
 #endif
\ No newline at end of file
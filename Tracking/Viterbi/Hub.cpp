@@ -0,0 +1,33 @@
+#include "Hub.h"
+#include <cstddef>  // To get NULL.
+#include "Node.h"
+#include "Trellis.h"
+
+Hub::Hub() : Arc(NULL, NULL, false), mTrellis(NULL), mLayer(0), mPosition(-1) {}
+
+Hub::~Hub() {
+	if (mTrellis != NULL) {
+		mTrellis->RemoveHub(this);
+	}
+}
+
+// The entries and the exits are chosen independently, as the score is a sum of an entry score
+// and an exit score.
+Arc *Hub::GetArc(Node *aStart, Node *aEnd) {
+	int bestEntry = -1;
+	for (int i=0; i<GetNumEntries(); i++) {
+		if (mEntryNodes[i] == aStart && (bestEntry == -1 || GetEntryScore(i) > GetEntryScore(bestEntry))) {
+			bestEntry = i;
+		}
+	}
+	int bestExit = -1;
+	for (int j=0; j<GetNumExits(); j++) {
+		if (mExitNodes[j] == aEnd && (bestExit == -1 || GetExitScore(j) > GetExitScore(bestExit))) {
+			bestExit = j;
+		}
+	}
+	if (bestEntry == -1 || bestExit == -1) {
+		return NULL;
+	}
+	return CreateArc(bestEntry, bestExit);
+}
@@ -0,0 +1,77 @@
+#ifndef HUB
+#define HUB
+
+#include <vector>
+#include "Arc.h"
+
+class Node;
+class Trellis;
+
+using namespace std;
+
+// A Hub represents a complete bipartite set of arcs from a set of entry nodes in one layer of a
+// Trellis to a set of exit nodes in the next layer. The score of the arc from entry i to exit j is
+// GetEntryScore(i) + GetScore() + GetExitScore(j). Instead of storing all of the arcs, the Trellis
+// finds the best entry of the hub once per sweep, so that the cost is linear in the number of entries
+// and exits. The same node can occur in multiple entries or exits. The class is abstract, and the
+// sub-classes define the scores and the arcs that the paths through the hub correspond to.
+//
+// The Hub is an Arc, so that it can be stored in the Viterbi tables of the Trellis, but it does not
+// start or end in any node. When a path goes through the hub, the Trellis calls GetArc to get a
+// real arc between the nodes before and after the hub.
+class Hub : public Arc {
+	// The Trellis stores its position in the Trellis.
+	friend class Trellis;
+
+public:
+	Hub();
+
+	// Removes the hub from the Trellis that it is in.
+	virtual ~Hub();
+
+	// Returns the number of entries.
+	int GetNumEntries() const { return (int) mEntryNodes.size(); }
+
+	// Returns the number of exits.
+	int GetNumExits() const { return (int) mExitNodes.size(); }
+
+	// Returns the node that entry aEntry starts in.
+	Node *GetEntryNode(int aEntry) { return mEntryNodes[aEntry]; }
+
+	// Returns the node that exit aExit ends in.
+	Node *GetExitNode(int aExit) { return mExitNodes[aExit]; }
+
+	// Should return the score of going through entry aEntry.
+	virtual double GetEntryScore(int aEntry) const = 0;
+
+	// Should return the score of going through exit aExit.
+	virtual double GetExitScore(int aExit) const = 0;
+
+	// GetScore, which is inherited from Arc, should return the score that is added to all paths
+	// through the hub. The scores may only change when the arcs ending in the exit layer change, so
+	// that the Trellis recomputes the layer.
+
+	// Returns an arc from aStart to aEnd that represents the highest scoring path through the hub
+	// between the two nodes. If multiple entries or exits have the same score, the first one is used.
+	// NULL is returned if there is no such path.
+	Arc *GetArc(Node *aStart, Node *aEnd);
+
+protected:
+	// Adds an entry that starts in aNode.
+	void AddEntry(Node *aNode) { mEntryNodes.push_back(aNode); }
+
+	// Adds an exit that ends in aNode.
+	void AddExit(Node *aNode) { mExitNodes.push_back(aNode); }
+
+	// Should return an arc that represents the path through entry aEntry and exit aExit. The arc
+	// belongs to the hub, and must not be in the arc lists of the nodes.
+	virtual Arc *CreateArc(int aEntry, int aExit) = 0;
+
+private:
+	vector<Node*> mEntryNodes;	// Nodes that the entries start in.
+	vector<Node*> mExitNodes;	// Nodes that the exits end in.
+	Trellis *mTrellis;			// The Trellis that the hub is in, or NULL.
+	int mLayer;					// The layer of mTrellis that the exit nodes are in.
+	int mPosition;				// The position of the hub in the hub list of the layer.
+};
+#endif
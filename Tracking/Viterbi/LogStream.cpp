@@ -5,7 +5,7 @@
 
 using namespace std;
 
-LogStream lout;
+thread_local LogStream lout;
 
 // Closes the text file in case the user forgot to do that.
 LogStream::~LogStream()
@@ -22,4 +22,22 @@ void LogStream::OpenFile(string aName)
 void LogStream::CloseFile()
 {
 	mBuffer.CloseFile();
+}
+
+void LogStream::StartCapture()
+{
+	flush();
+	mBuffer.StartCapture();
+}
+
+string LogStream::EndCapture()
+{
+	flush();
+	return mBuffer.EndCapture();
+}
+
+void LogStream::SetAsync(bool aAsync)
+{
+	flush();
+	mBuffer.SetAsync(aAsync);
 }
\ No newline at end of file
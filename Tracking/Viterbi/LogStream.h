@@ -15,12 +15,26 @@ using namespace std;
 // and redefining sync function of the stringbuf member object. The printout can be turned
 // on or off but it is turned on when objects are created. There is a globally available
 // LogStream object named lout declared at the end of this header. This object should be
-// used for all printouts.
+// used for all printouts. Every thread has its own lout object, so threads can write to it
+// without locking. Matlab functions can only be called from the thread that runs the mex-file,
+// so other threads have to capture their outputs using StartCapture and EndCapture, and let
+// that thread write them.
+//
+// The verbosity determines which outputs are generated. Code that writes outputs which are not
+// needed at all verbosities should check IsVerbose first, so that the text is never formatted
+// when it is not needed. The default verbosity is VERBOSITY_EVENTS, which gives all outputs. In
+// asynchronous mode, the outputs are written by a background thread. See LogStreamBuffer.
 class LogStream: public ostream
 {
     public:
+        // Verbosity levels. Warnings are always printed.
+        static const int VERBOSITY_WARNINGS = 0;
+        static const int VERBOSITY_SUMMARY = 1;		// Outputs at the start and the end of the linking.
+        static const int VERBOSITY_ITERATIONS = 2;	// A few lines per iteration.
+        static const int VERBOSITY_EVENTS = 3;		// One line per executed event and the final tracks.
+
         LogStream()
-            :ostream(&mBuffer) {}
+            :ostream(&mBuffer), mVerbosity(VERBOSITY_EVENTS) {}
             
         ~LogStream();
 
@@ -36,13 +50,34 @@ class LogStream: public ostream
        // Turns printouts to all output locations on or off.
        void SetPrintout(bool aDoPrint) { mBuffer.SetPrintout(aDoPrint); }
 
+       // Makes subsequent outputs go into a string that is returned by EndCapture.
+       void StartCapture();
+
+       // Stops capturing outputs and returns the outputs that were captured.
+       string EndCapture();
+
+       // Returns the verbosity level.
+       int GetVerbosity() const { return mVerbosity; }
+
+       // Returns true if outputs at level aLevel should be generated.
+       bool IsVerbose(int aLevel) const { return mVerbosity >= aLevel; }
+
+       // Turns asynchronous writing of the outputs on or off. When it is turned off, all outputs
+       // have been written when the function returns.
+       void SetAsync(bool aAsync);
+
+       // Sets the verbosity level.
+       void SetVerbosity(int aVerbosity) { mVerbosity = aVerbosity; }
+
 private:
 	// Modified string buffer wich will send text outputs to the correct places.
 	LogStreamBuffer mBuffer;
+
+	int mVerbosity;
             
 };
 
-// Globally available LogStream object.
-extern LogStream lout;
+// Globally available LogStream object, with one instance per thread.
+extern thread_local LogStream lout;
 
 #endif
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "LogStreamBuffer.h"
 
+#include <chrono>
 #include <string>
 #include <iostream>
 #include <fstream>
@@ -11,39 +12,158 @@
 
 using namespace std;
 
-LogStreamBuffer::LogStreamBuffer() : mDoPrint(true) {
+LogStreamBuffer::LogStreamBuffer() : mDoPrint(true), mCapture(false), mHead(0), mTail(0), mStopWriter(false) {
+}
+
+LogStreamBuffer::~LogStreamBuffer() {
+	SetAsync(false);
 }
 
 int LogStreamBuffer::sync()
 {
+	if (!mDoPrint) {
+		str("");
+		return 0;
+	}
+
+	if (mCapture) {
+		mCaptured += str();
+		str("");
+		return 0;
+	}
+
+	if (GetAsync()) {
+		string record = str();
+		str("");
+		if (record.empty()) {
+			return 0;
+		}
+
+#ifdef MATLAB
+		// The background thread can not print to the Matlab command window.
+		mConsole += record;
+		if (mConsole.size() >= CONSOLE_BATCH) {
+			PrintToConsole(mConsole);
+			mConsole.clear();
+		}
+#endif
+
+		// Wait for the background thread if the ring buffer is full.
+		size_t tail = mTail.load(memory_order_relaxed);
+		while (tail - mHead.load(memory_order_acquire) == RING_SIZE) {
+			this_thread::yield();
+		}
+		mRing[tail % RING_SIZE].swap(record);
+		mTail.store(tail + 1, memory_order_release);
+		return 0;
+	}
+
 	// Write output to log file. There won't an error if no file is open.
 	logFile << str().c_str();
 	logFile.flush();
 
+	PrintToConsole(str());
 
+	// The string buffer has been printed and needs to be cleared. cout has it's own un-modified sting buffer
+	// which is emptied automatically.
+	str("");
+
+	return 0;
+}
+
+void LogStreamBuffer::PrintToConsole(const string &aText)
+{
 #ifdef MATLAB
 	// Write ouput to matlab command window.
-	mexPrintf("%s",str().c_str());
+	mexPrintf("%s",aText.c_str());
 #else
 	// Write output to windows command window.
-	cout << str().c_str();
+	cout << aText.c_str();
 	cout.flush();
 #endif
+}
+
+void LogStreamBuffer::SetAsync(bool aAsync)
+{
+	if (aAsync == GetAsync()) {
+		return;
+	}
+
+	if (aAsync) {
+		mRing.assign(RING_SIZE, string());
+		mStopWriter.store(false);
+		mWriter = thread(&LogStreamBuffer::WriteRecords, this);
+	} else {
+		mStopWriter.store(true, memory_order_release);
+		mWriter.join();
+		mRing.clear();
+#ifdef MATLAB
+		PrintToConsole(mConsole);
+		mConsole.clear();
+#endif
+	}
+}
 
-	// The string buffer has been printed and needs to be cleared. cout has it's own un-modified sting buffer
-	// which is emptied automatically.
-	str("");
+// The records that are available are concatenated and written with a single call, and the log
+// file is only flushed once per batch. The thread sleeps for a millisecond when there is nothing
+// to write. The stop flag is read before the records, so that records synced before the flag was
+// set are always written.
+void LogStreamBuffer::WriteRecords()
+{
+	string batch;
+	while (true) {
+		bool stop = mStopWriter.load(memory_order_acquire);
+		size_t head = mHead.load(memory_order_relaxed);
+		size_t tail = mTail.load(memory_order_acquire);
+		for (; head != tail; head++) {
+			batch += mRing[head % RING_SIZE];
+			mRing[head % RING_SIZE].clear();
+		}
+		mHead.store(head, memory_order_release);
 
-	return 0;
+		if (!batch.empty()) {
+			logFile << batch;
+			logFile.flush();
+#ifndef MATLAB
+			PrintToConsole(batch);
+#endif
+			batch.clear();
+		} else if (stop) {
+			break;
+		} else {
+			this_thread::sleep_for(chrono::milliseconds(1));
+		}
+	}
 }
         
+void LogStreamBuffer::StartCapture()
+{
+	mCapture = true;
+	mCaptured.clear();
+}
+
+string LogStreamBuffer::EndCapture()
+{
+	mCapture = false;
+	string captured;
+	captured.swap(mCaptured);
+	return captured;
+}
+
+// The background thread is stopped while the file is changed.
 void LogStreamBuffer::OpenFile(string aName)
 {
+	bool async = GetAsync();
+	SetAsync(false);
 	logFile.open(aName.c_str());
+	SetAsync(async);
 }
         
 void LogStreamBuffer::CloseFile()
 {
+	bool async = GetAsync();
+	SetAsync(false);
 	// There won't be an error if the file is already closed.
 	logFile.close();
+	SetAsync(async);
 }
\ No newline at end of file
@@ -1,20 +1,34 @@
 #ifndef LOGSTREAMBUFFER
 #define LOGSTREAMBUFFER
 
+#include <atomic>
 #include <fstream>
 #include <string>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 using namespace std;
 
 // String buffer class with a modified sync function wich will send text outputs to either the
 // matlab command line or to the windows command line. The buffer can also open and close a log
 // file where all outputs can be stored.
+//
+// In asynchronous mode, sync puts the text into a ring buffer instead of writing it, and a
+// background thread writes the contents of the ring buffer to the log file, and to the windows
+// command line, in large batches. The thread which owns the buffer is the only producer and the
+// background thread is the only consumer, so the ring buffer does not need locks. Matlab functions
+// can not be called from the background thread, so outputs to the Matlab command line are instead
+// collected and printed by the owning thread when there is a lot of text or when the
+// asynchronous mode is turned off.
 class LogStreamBuffer: public stringbuf
 {
 public:
 	LogStreamBuffer();
 
+	// Stops the background thread if the buffer is in asynchronous mode.
+	virtual ~LogStreamBuffer();
+
 	// Function which will send text output to the appropriate places whenever the LogStream is
 	// flushed.
 	virtual int sync();
@@ -31,12 +45,51 @@ public:
     // Turns printouts to all output locations on or off.
     void SetPrintout(bool aDoPrint) { mDoPrint = aDoPrint; }
 
+	// Makes subsequent outputs go into a string instead of to the output locations.
+	void StartCapture();
+
+	// Stops capturing outputs and returns the outputs that were captured.
+	string EndCapture();
+
+	// Returns true if the buffer is in asynchronous mode.
+	bool GetAsync() const { return mWriter.joinable(); }
+
+	// Turns asynchronous mode on or off. When it is turned off, all outputs are written before the
+	// function returns.
+	void SetAsync(bool aAsync);
+
 private:
+	// The number of records that the ring buffer can hold. Must be a power of 2.
+	static const size_t RING_SIZE = 4096;
+
+	// The amount of text that is collected before it is printed to the Matlab command line.
+	static const size_t CONSOLE_BATCH = 65536;
+
 	// File stream to a log file that records everything sent to the command window.
 	ofstream logFile;
     
     // If mDoPrint is true, output is printed to all output locations. Otherwise,
     // no outputs are printed.
     bool mDoPrint;
+
+	bool mCapture;		// True if outputs are captured instead of printed.
+	string mCaptured;	// Outputs captured since StartCapture was called.
+
+	// Records that have been synced but not yet written in asynchronous mode. The records from
+	// mHead to mTail-1, modulo RING_SIZE, are waiting. mTail is only changed by the producer and
+	// mHead is only changed by the consumer.
+	vector<string> mRing;
+	atomic<size_t> mHead;
+	atomic<size_t> mTail;
+
+	thread mWriter;				// Background thread which writes the records.
+	atomic<bool> mStopWriter;	// Tells the background thread to write the remaining records and stop.
+	string mConsole;			// Text for the Matlab command line in asynchronous mode.
+
+	// Writes aText to the command line.
+	void PrintToConsole(const string &aText);
+
+	// Function run by the background thread.
+	void WriteRecords();
 };
 #endif
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "Migration.h"
 #include <algorithm>
+#include <assert.h>
+#include <cstddef>  // To get NULL.
 #include <vector>
 #include "CellNode.h"
 #include "Detection.h"
@@ -17,6 +19,14 @@ Migration::Migration(Detection *aStartDetection, Detection *aEndDetection,
 	: Event((State*) aStartDetection, (State*) aEndDetection, aValue, aNumScores, aScore),
 	mMaxScore(aMaxMigScore) {
 		aStartDetection->AddMigration(this);
+
+		// Mitosis events that replace the migration.
+		Detection::MitosisIterator firstMit;
+		Detection::MitosisIterator lastMit;
+		aStartDetection->GetMitosis(aEndDetection, firstMit, lastMit);
+		for (Detection::MitosisIterator it = firstMit; it != lastMit; ++it) {
+			(*it)->SetMigration(this);
+		}
 }
 
 // Migrations are effectively set to true whenever they have a positive score.
@@ -47,11 +57,38 @@ void Migration::Execute(Tree *aTree, vector<CellNode*> *aEndCellNodes, bool aPri
 void Migration::Execute(Tree *aTree, vector<CellNode*> *aEndCellNodes, CellNode *aCell) {
 
 	CellNode *activeCell = aTree->GetActiveCell();
-	activeCell->AddLink(this, aCell);
+	activeCell->AddLink(aTree, this, aCell);
 
 	aEndCellNodes->push_back(aCell);
 }
 
+void Migration::AddCell(CellNode *aCell) {
+	mCells.push_back(aCell);
+}
+
+// There is rarely more than one cell in the list.
+void Migration::RemoveCell(CellNode *aCell) {
+	mCells.erase(find(mCells.begin(), mCells.end(), aCell));
+}
+
+// If there are multiple CellNodes, the start Detection is searched, so that the same CellNode is
+// returned regardless of the order in which the links were created.
+CellNode *Migration::GetCell() const {
+	if (mCells.empty()) {
+		return NULL;
+	}
+	if (mCells.size() == 1) {
+		return mCells[0];
+	}
+	for (State::CellIterator cIt = mStartState->GetBeginCell(); cIt < mStartState->GetEndCell(); ++cIt) {
+		if ((*cIt)->GetNextEvent() == this) {
+			return *cIt;
+		}
+	}
+	assert(false);
+	return NULL;
+}
+
 double Migration::GetScore() const {
 	return mEndState->GetPlusScore() + GetPlusScore();
 }
@@ -67,7 +104,7 @@ void Migration::Plus() {
 	Detection::MitosisIterator lastMit;
 	((Detection*) mStartState)->GetMitosis((Detection*) mEndState, firstMit, lastMit);
 	for (Detection::MitosisIterator it = firstMit; it != lastMit; ++it) {
-		Mitosis *mit = it->second;
+		Mitosis *mit = *it;
 		if (!mit->IsInTrellis()) {
 			mit->AddToTrellis();
 		}
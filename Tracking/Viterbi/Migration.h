@@ -32,6 +32,9 @@ public:
 	// Should probably be changed, at least for the tracking challenge.
 	virtual double GetMinusScore() const;
 
+	// The list of CellNodes is on the heap once a cell has used the migration.
+	virtual bool OwnsHeapMemory() const { return Event::OwnsHeapMemory() || mCells.capacity() > 0; }
+
 	// Adds another instance of the migration to aTree.
 	virtual void Execute(Tree *aTree, vector<CellNode*> *aEndCellNodes, bool aPrint = true);
 
@@ -43,9 +46,23 @@ public:
 	// aCell - CellNode associated with aEndState.
 	virtual void Execute(Tree *aTree, vector<CellNode*> *aEndCellNodes, CellNode* aCell);
 
+	// Adds aCell to the CellNodes that are linked to the next CellNode through the migration.
+	virtual void AddCell(CellNode *aCell);
+
+	// Removes aCell from the CellNodes that are linked to the next CellNode through the migration.
+	virtual void RemoveCell(CellNode *aCell);
+
+	// Returns the first CellNode of the start Detection that is linked to the next CellNode through
+	// the migration, or NULL if there is no such CellNode. The CellNodes are ordered in the same
+	// way as in the start Detection.
+	CellNode *GetCell() const;
+
 	// Returns the score associated with adding the migration event to a Tree.
 	virtual double GetScore() const;
 
+	// The score only depends on the migration counter and the cell count of the end Detection.
+	virtual bool HasLocalScore() const { return true; }
+
 	// Increases the count but does not add any mitotic events to the CellTrellis.
 	void Increment();
 
@@ -56,5 +73,6 @@ public:
 
 private:
 	double mMaxScore;
+	vector<CellNode*> mCells;  // CellNodes that are linked to the next CellNode through the migration.
 };
 #endif
\ No newline at end of file
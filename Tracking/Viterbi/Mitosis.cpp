@@ -17,6 +17,7 @@ Mitosis::Mitosis(IdleState *aStartState, Detection *aEndState, Detection *aStart
 	: Event((State*) aStartState, (State*) aEndState, aValue, aNumScores, aScore), mIsInTrellis(false) {
 		mStartDetection = aStartDetection;
 		mOtherChild = aOtherChild;
+		mMigration = NULL;  // Set by the Migration constructor.
 		mStartDetection->AddMitosis(this);
 		mMirror = NULL;
 		// Mitosis events are not added to the CellTrellis until the required migration is present.
@@ -87,13 +88,13 @@ void Mitosis::Execute(Tree *aTree, vector<CellNode*> *aEndCellNodes, bool aPrint
 	CellNode *nextCell = cell->GetNextCell();
 	cell->RemoveLink(aTree);
 	CellNode *child1 = aTree->CreateCellFirst((IdleState*) mStartState);
-	child1->AddLink(GetMirror(), nextCell);
+	child1->AddLink(aTree, GetMirror(), nextCell);
 	
 	aTree->SetActiveCell(child2);
 	aTree->CreateCellLink(child2, this);
 
 	// Add the children (the CellNodes after the IdleStates).
-	cell->AddChildren(this, child1->GetNextCell(), child2->GetNextCell());
+	cell->AddChildren(aTree, this, child1->GetNextCell(), child2->GetNextCell());
 
 	// We need to increment the values of the migrations as they are included in the mitosis.
 	oldMig->Increment();
@@ -125,13 +126,13 @@ void Mitosis::Execute(Tree *aTree, vector<CellNode*> *aEndCellNodes, CellNode *a
 	CellNode *nextCell =  cell->GetNextCell();
 	cell->RemoveLink(aTree);
 	CellNode *child1 = aTree->CreateCellFirst((IdleState*) mStartState);
-	child1->AddLink(GetMirror(), nextCell);
+	child1->AddLink(aTree, GetMirror(), nextCell);
 	
 	aTree->SetActiveCell(child2);
-	child2->AddLink(this, aCell);
+	child2->AddLink(aTree, this, aCell);
 
 	// Add the children.
-	cell->AddChildren(this, child1->GetNextCell(), child2->GetNextCell());
+	cell->AddChildren(aTree, this, child1->GetNextCell(), child2->GetNextCell());
 
 	// We need to increment the values of the migrations as they are included in the mitosis.
 	oldMig->Increment();
@@ -181,13 +182,10 @@ double Mitosis::GetScore() const {
 
 // The function is const to allow GetScore to call it.
 CellNode *Mitosis::GetAcceptingCell() const {
-	for (Detection::CellIterator cIt = mStartDetection->GetBeginCell(); cIt < mStartDetection->GetEndCell(); ++cIt) {
-		CellNode *cell = *cIt;
-		if (cell->HasNextCell() && cell->GetNextCell()->GetState() == (State*) mOtherChild) {
-			return cell;  
-		}
+	if (mMigration == NULL) {
+		return NULL;
 	}
-	return NULL;
+	return mMigration->GetCell();
 }
 
 // TODO: REFINE THIS SO THAT IT ALLOWS A SWAP WHEN THERE ARE MULIPLE CELLS IN THE DETECTION.
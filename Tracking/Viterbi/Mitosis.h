@@ -7,6 +7,7 @@
 class CellNode;
 class Detection;
 class IdleState;
+class Migration;
 class Tree;
 
 // A Mitosis object is an Event where one cell divides (undergoes mitosis) so that
@@ -58,6 +59,10 @@ public:
 	// Sets the mirror object and also sets the mirror object of the mirror object.
 	void LinkMirror(Mitosis *aMirror);
 
+	// Specifies the migration from the parent cell detection to mOtherChild, which is replaced by the
+	// mitosis. Called by the Migration constructor.
+	void SetMigration(Migration *aMigration) { mMigration = aMigration; }
+
 	// Avoids swaps where the mitosis replaces a migration which is required for the mitosis.
 	virtual bool OkSwap12(Event *aEvent);
 
@@ -74,8 +79,12 @@ private:
 	// Detection will be removed and replaced by this Mitosis when it is put into the cell tree.
 	Detection *mOtherChild;
 
+	// The migration from mStartDetection to mOtherChild, or NULL if there is no such migration.
+	Migration *mMigration;
+
 	// Returns a CellNode which is linked with a migration that can be replaced by the current Mitosis
-	// if such a CellNode exist, and NULL otherwise.
+	// if such a CellNode exist, and NULL otherwise. The CellNodes linked with the migration are indexed
+	// by the Migration, so this does not require a search through the CellNodes of mStartDetection.
 	CellNode *GetAcceptingCell() const;
 
 	// True if the Mitosis is an arc in the CellTrellis.
@@ -1,50 +1,111 @@
 #include "Node.h"
+#include <cstddef>  // To get NULL.
 #include <vector>
 #include <assert.h>
 #include "Arc.h"
+#include "Trellis.h"
 
-Node::Node(int aIndex) : mIndex(aIndex) {}
+Node::Node(int aIndex) : mIndex(aIndex), mLayer(0), mTrellis(NULL), mNumForwardHoles(0), mNumBackwardHoles(0) {}
 
 Node::~Node() {
-	// TODO: TRY TO MAKE THIS NICER.
-
-	// When the arcs are deleted, they first remove themselves from the associated nodes.
-	while (mForwardArcs.size()>0) {
-		delete *mForwardArcs.begin();
+	// When the arcs are deleted, they first remove themselves from the associated nodes. Removed
+	// arcs only leave holes in the lists, so the lists can be traversed while the arcs are deleted.
+	for (int i=0; i<(int)mForwardArcs.size(); i++) {
+		if (mForwardArcs[i] != NULL) {
+			delete mForwardArcs[i];
+		}
 	}
 
-	// When the arcs are deleted, they first remove themselves from the associated nodes.
-	while (mBackwardArcs.size()>0) {
-		delete *mBackwardArcs.begin();
+	for (int i=0; i<(int)mBackwardArcs.size(); i++) {
+		if (mBackwardArcs[i] != NULL) {
+			delete mBackwardArcs[i];
+		}
 	}
 }
 
 void Node::AddForwardArc(Arc *aArc) {
 	assert(this == aArc->GetStartNode());
+	// Compact the list if it is mostly holes, so that it does not grow when arcs are added and removed repeatedly.
+	if (2*mNumForwardHoles > (int)mForwardArcs.size()) {
+		CompactForwardArcs();
+	}
+	aArc->mStartPosition = (int) mForwardArcs.size();
 	mForwardArcs.push_back(aArc);
 }
 
 void Node::AddBackwardArc(Arc *aArc) {
 	assert(this == aArc->GetEndNode());
+	if (2*mNumBackwardHoles > (int)mBackwardArcs.size()) {
+		CompactBackwardArcs();
+	}
+	aArc->mEndPosition = (int) mBackwardArcs.size();
 	mBackwardArcs.push_back(aArc);
+	if (mTrellis != NULL) {
+		mTrellis->SetArcsChanged(mLayer);
+	}
 }
 
+// Arcs that are not in the list have the position -1.
 void Node::RemoveForwardArc(Arc *aArc) {
-	// Slow way of erasing an element.
-	for (int i=0; i<mForwardArcs.size(); i++) {
-		if (mForwardArcs[i] == aArc) {
-			mForwardArcs.erase(mForwardArcs.begin()+i);
-			break;
-		}
+	if (aArc->mStartPosition < 0) {
+		return;
 	}
+	assert(mForwardArcs[aArc->mStartPosition] == aArc);
+	mForwardArcs[aArc->mStartPosition] = NULL;
+	aArc->mStartPosition = -1;
+	mNumForwardHoles++;
 }
 
+// Arcs that are not in the list have the position -1.
 void Node::RemoveBackwardArc(Arc *aArc) {
-	// Slow way of erasing an element.
-	for (int i=0; i<mBackwardArcs.size(); i++) {
-		if (mBackwardArcs[i] == aArc) {
-			mBackwardArcs.erase(mBackwardArcs.begin()+i);
-			break;
+	if (aArc->mEndPosition < 0) {
+		return;
+	}
+	assert(mBackwardArcs[aArc->mEndPosition] == aArc);
+	mBackwardArcs[aArc->mEndPosition] = NULL;
+	aArc->mEndPosition = -1;
+	mNumBackwardHoles++;
+	if (mTrellis != NULL) {
+		mTrellis->SetArcsChanged(mLayer);
+	}
+}
+
+// The arcs are marked as removed, so that they can be deleted afterwards.
+void Node::ClearArcs() {
+	for (int i=0; i<(int)mForwardArcs.size(); i++) {
+		if (mForwardArcs[i] != NULL) {
+			mForwardArcs[i]->mStartPosition = -1;
+		}
+	}
+	for (int i=0; i<(int)mBackwardArcs.size(); i++) {
+		if (mBackwardArcs[i] != NULL) {
+			mBackwardArcs[i]->mEndPosition = -1;
+		}
+	}
+	mForwardArcs.clear();
+	mBackwardArcs.clear();
+	mNumForwardHoles = 0;
+	mNumBackwardHoles = 0;
+}
+
+void Node::Compact(vector<Arc*> &aArcs, bool aForward) {
+	int n = 0;
+	for (int i=0; i<(int)aArcs.size(); i++) {
+		if (aArcs[i] != NULL) {
+			if (aForward) {
+				aArcs[i]->mStartPosition = n;
+			} else {
+				aArcs[i]->mEndPosition = n;
+			}
+			aArcs[n] = aArcs[i];
+			n++;
 		}
 	}
+	aArcs.resize(n);
+}
+
+void Node::SetChanged() {
+	if (mTrellis != NULL) {
+		mTrellis->SetChanged(mLayer, mIndex);
+	}
 }
\ No newline at end of file
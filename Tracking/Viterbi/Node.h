@@ -4,6 +4,7 @@
 #include <vector>
 
 class Arc;
+class Trellis;
 
 using namespace std;
 
@@ -18,18 +19,22 @@ public:
 	// arcs from the arc lists of all nodes that they occur in.
     virtual ~Node();
 
-	Arc *GetForwardArc(int aIndex) { return mForwardArcs[aIndex]; }
+	// Returns arc aIndex among the arcs that start in the node. The arcs are in the order in which
+	// they were added.
+	Arc *GetForwardArc(int aIndex) { CompactForwardArcs(); return mForwardArcs[aIndex]; }
 
 	// Returns the index of the node.
 	int GetIndex() const { return mIndex; }
     
-	Arc *GetBackwardArc(int aIndex) { return mBackwardArcs[aIndex]; }
+	// Returns arc aIndex among the arcs that end in the node. The arcs are in the order in which
+	// they were added.
+	Arc *GetBackwardArc(int aIndex) { CompactBackwardArcs(); return mBackwardArcs[aIndex]; }
 
 	// Returns the number of arcs that start in the node.
-	int GetNumForwardArcs() const { return (int) mForwardArcs.size(); }
+	int GetNumForwardArcs() { CompactForwardArcs(); return (int) mForwardArcs.size(); }
     
 	// Returns the number of arcs that end in the node.
-	int GetNumBackwardArcs() const { return (int) mBackwardArcs.size(); }
+	int GetNumBackwardArcs() { CompactBackwardArcs(); return (int) mBackwardArcs.size(); }
 
 	// Adds a forward arc to the node. An assertion fails if the starting point of the arc
 	// is not this node.
@@ -39,15 +44,48 @@ public:
 	// is not this node.
     void AddBackwardArc(Arc *aArc);
 
-	// Removes aArc from the set of forward arc from the node.
+	// Removes aArc from the set of forward arc from the node. This takes constant time, as the arc
+	// knows its position in the arc list. The position is left empty until the arcs are accessed.
 	void RemoveForwardArc(Arc *aArc);
 
-	// Removes aArc from the set of backward arcs from the node.
+	// Removes aArc from the set of backward arcs from the node. This takes constant time, as the arc
+	// knows its position in the arc list. The position is left empty until the arcs are accessed.
 	void RemoveBackwardArc(Arc *aArc);
 
+	// Allocates space for aNumArcs more forward arcs.
+	void ReserveForwardArcs(int aNumArcs) { mForwardArcs.reserve(mForwardArcs.size() + aNumArcs); }
+
+	// Allocates space for aNumArcs more backward arcs.
+	void ReserveBackwardArcs(int aNumArcs) { mBackwardArcs.reserve(mBackwardArcs.size() + aNumArcs); }
+
+	// Empties the arc lists without deleting the arcs. This is used when all nodes and arcs
+	// of a Trellis are deleted together.
+	void ClearArcs();
+
+	// Tells the Trellis that the scores of the arcs ending in the node may have changed.
+	void SetChanged();
+
+	// Specifies the Trellis that the node is in and the layer that it is in. Called by Trellis::AddNode.
+	void SetTrellis(Trellis *aTrellis, int aLayer) { mTrellis = aTrellis; mLayer = aLayer; }
+
 private:
 	int mIndex;						// Index of the node in some container.
-	vector<Arc*> mForwardArcs;		// Arcs that start in the node.
-	vector<Arc*> mBackwardArcs;		// Arcs that end in the node.
+	int mLayer;						// The layer of mTrellis that the node is in.
+	Trellis *mTrellis;				// The Trellis that the node is in, or NULL.
+	vector<Arc*> mForwardArcs;		// Arcs that start in the node, with NULL in the positions of removed arcs.
+	vector<Arc*> mBackwardArcs;		// Arcs that end in the node, with NULL in the positions of removed arcs.
+	int mNumForwardHoles;			// The number of NULL elements in mForwardArcs.
+	int mNumBackwardHoles;			// The number of NULL elements in mBackwardArcs.
+
+	// Removes the NULL elements of mForwardArcs, without changing the order of the remaining arcs,
+	// and updates the positions stored in the arcs.
+	void CompactForwardArcs() { if (mNumForwardHoles > 0) { Compact(mForwardArcs, true); mNumForwardHoles = 0; } }
+
+	// Removes the NULL elements of mBackwardArcs, without changing the order of the remaining arcs,
+	// and updates the positions stored in the arcs.
+	void CompactBackwardArcs() { if (mNumBackwardHoles > 0) { Compact(mBackwardArcs, false); mNumBackwardHoles = 0; } }
+
+	// Removes the NULL elements of aArcs. aForward specifies if the arcs start or end in the node.
+	static void Compact(vector<Arc*> &aArcs, bool aForward);
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,330 @@
+#include "OnlineLinker.h"
+#include <algorithm>
+#include <assert.h>
+#include <limits>
+#include <sstream>
+#include <vector>
+#include "CellTrellis.h"
+#include "LogStream.h"
+#include "Tree.h"
+
+using namespace std;
+
+// Appends the aNumRows rows of the column-major matrix aA, which has aNumCols columns, to aRows.
+static void AppendRows(const double *aA, int aNumRows, int aNumCols, vector<double> &aRows) {
+	for (int i=0; i<aNumRows; i++) {
+		for (int j=0; j<aNumCols; j++) {
+			aRows.push_back(aA[j*aNumRows+i]);
+		}
+	}
+}
+
+// Puts the rows of the window images aBegin to aEnd-1 into a column-major matrix aA, where the image
+// numbers are counted from the first image of the window, aFirstT. Returns the number of rows.
+static int ToMatrix(const vector<vector<double> > &aRows, int aBegin, int aEnd, int aNumCols, int aFirstT,
+	vector<double> &aA) {
+
+		int numRows = 0;
+		for (int i=aBegin; i<aEnd; i++) {
+			numRows += (int) aRows[i].size() / aNumCols;
+		}
+		aA.assign(max(numRows * aNumCols, 1), 0.0);
+		int r = 0;
+		for (int i=aBegin; i<aEnd; i++) {
+			for (int k=0; k<(int)aRows[i].size()/aNumCols; k++) {
+				for (int j=0; j<aNumCols; j++) {
+					aA[j*numRows+r] = aRows[i][k*aNumCols+j];
+				}
+				aA[r] -= aFirstT - 1;
+				r++;
+			}
+		}
+		return numRows;
+}
+
+OnlineLinker::OnlineLinker(bool aSingleIdleState, int aMaxCount, double aMaxMigScore, int aWindowSize, int aHorizon,
+	int aNumThreads)
+	: mSingleIdleState(aSingleIdleState), mMaxCount(aMaxCount), mMaxMigScore(aMaxMigScore), mWindowSize(aWindowSize),
+	mHorizon(aHorizon), mNumThreads(aNumThreads), mBatchSize(1), mLazySwaps(false), mMinScore(0), mWindowed(false),
+	mNumT(0), mFirstT(1), mLinkedT(0) {
+		assert(mWindowSize >= 2 && mHorizon >= 1 && mHorizon < mWindowSize);
+}
+
+void OnlineLinker::AddImage(int aNumDets, const double *aCountA, int aNumMigs, const double *aMigA, int aNumMits,
+	const double *aMitA, int aNumApos, const double *aApoA, int aNumAppear, const double *aAppearA,
+	int aNumDisappear, const double *aDisappearA) {
+
+		mNumT++;
+		mNumDets.push_back(aNumDets);
+		mCountRows.push_back(vector<double>());
+		mMigRows.push_back(vector<double>());
+		mMitRows.push_back(vector<double>());
+		mApoRows.push_back(vector<double>());
+		mAppearRows.push_back(vector<double>());
+		mDisappearRows.push_back(vector<double>());
+		AppendRows(aCountA, aNumDets, mMaxCount+3, mCountRows.back());
+		AppendRows(aMigA, aNumMigs, 5, mMigRows.back());
+		AppendRows(aMitA, aNumMits, 6, mMitRows.back());
+		AppendRows(aApoA, aNumApos, 4, mApoRows.back());
+		AppendRows(aAppearA, aNumAppear, 4, mAppearRows.back());
+		AppendRows(aDisappearA, aNumDisappear, 4, mDisappearRows.back());
+
+		if (mError.empty() && mNumT - mFirstT + 1 >= mWindowSize) {
+			Link();
+			Freeze(mNumT - mHorizon + 1);
+		}
+}
+
+void OnlineLinker::Finish() {
+	if (mError.empty() && mLinkedT < mNumT) {
+		Link();
+	}
+}
+
+// The first image of the window is frozen if images have been removed from the window before. Then
+// the cells in its detections are continuations of frozen tracks.
+void OnlineLinker::Link() {
+	int numT = mNumT - mFirstT + 1;  // The number of images in the window.
+	bool frozenFirst = (mFirstT > 1);
+
+	if (lout.IsVerbose(LogStream::VERBOSITY_SUMMARY)) {
+		lout << "Linking images " << mFirstT << " to " << mNumT << "." << endl << endl;
+	}
+
+	// The cells that are present in the window, and their indices in the window.
+	vector<int> windowCells;
+	vector<int> windowIndices(GetNumCells(), -1);
+	for (int c=0; c<GetNumCells(); c++) {
+		if (mCellStarts[c] + (int) mCellDets[c].size() - 1 >= mFirstT) {
+			windowIndices[c] = (int) windowCells.size();
+			windowCells.push_back(c);
+		}
+	}
+
+	// The number of cells in the detections of the frozen image.
+	vector<int> firstCounts(mNumDets[0], 0);
+	int maxCount = mMaxCount;
+	if (frozenFirst) {
+		for (int i=0; i<(int)windowCells.size(); i++) {
+			int c = windowCells[i];
+			if (mCellStarts[c] <= mFirstT) {
+				firstCounts[mCellDets[c][mFirstT - mCellStarts[c]]]++;
+			}
+		}
+		for (int d=0; d<mNumDets[0]; d++) {
+			maxCount = max(maxCount, firstCounts[d] + 1);
+		}
+	}
+
+	// Input matrices for the CellTrellis. The count scores of the frozen image are 0 for the current
+	// number of cells and -infinity for all other numbers. The count scores of other images are
+	// extended to maxCount using the last score, which is used for all larger counts anyway.
+	vector<double> numDetsA(numT);
+	int numDets = 0;
+	for (int i=0; i<numT; i++) {
+		numDetsA[i] = mNumDets[i];
+		numDets += mNumDets[i];
+	}
+	vector<double> countA(max((maxCount+3) * numDets, 1));
+	int r = 0;
+	for (int i=0; i<numT; i++) {
+		for (int k=0; k<mNumDets[i]; k++) {
+			const double *row = &mCountRows[i][k*(mMaxCount+3)];
+			int d = (int) row[1] - 1;
+			countA[r] = row[0] - mFirstT + 1;
+			countA[numDets+r] = row[1];
+			for (int cnt=0; cnt<maxCount+1; cnt++) {
+				double score = row[2+min(cnt, mMaxCount)];
+				if (i == 0 && frozenFirst) {
+					score = (cnt == firstCounts[d]) ? 0.0 : -numeric_limits<double>::infinity();
+				}
+				countA[(2+cnt)*numDets+r] = score;
+			}
+			r++;
+		}
+	}
+
+	// Events that start in the last image of the window, or end in the first, are left out.
+	vector<double> migA, mitA, apoA, appearA, disappearA;
+	int numMigs = ToMatrix(mMigRows, 0, numT-1, 5, mFirstT, migA);
+	int numMits = ToMatrix(mMitRows, 0, numT-1, 6, mFirstT, mitA);
+	int numApos = ToMatrix(mApoRows, 0, numT-1, 4, mFirstT, apoA);
+	int numAppear = ToMatrix(mAppearRows, 1, numT, 4, mFirstT, appearA);
+	int numDisappear = ToMatrix(mDisappearRows, 0, numT-1, 4, mFirstT, disappearA);
+
+	CellTrellis cellTrellis(mSingleIdleState, numT, maxCount, numMigs, numMits, numApos, numAppear, numDisappear,
+		&numDetsA[0], &countA[0], &migA[0], &mitA[0], &apoA[0], &appearA[0], &disappearA[0], mMaxMigScore, mNumThreads);
+	cellTrellis.SetWindowed(mWindowed);
+	cellTrellis.SetBatchSize(mBatchSize);
+	cellTrellis.SetLazySwaps(mLazySwaps);
+	cellTrellis.SetMinScore(mMinScore);
+
+	// Add the cells that are already in the window.
+	int numOld = (int) windowCells.size();
+	if (numOld > 0) {
+		vector<double> cellA(numT*numOld, 0.0);
+		vector<double> divA(2*numOld, 0.0);
+		vector<double> deathA(numOld, 0.0);
+		for (int i=0; i<numOld; i++) {
+			int c = windowCells[i];
+			for (int j=max(0, mFirstT - mCellStarts[c]); j<(int)mCellDets[c].size(); j++) {
+				cellA[i*numT + mCellStarts[c] + j - mFirstT] = mCellDets[c][j] + 1.0;
+			}
+			if (mChildren1[c] != -1) {
+				divA[i] = windowIndices[mChildren1[c]] + 1.0;
+				divA[numOld+i] = windowIndices[mChildren2[c]] + 1.0;
+			}
+			deathA[i] = mDeaths[c] ? 1.0 : 0.0;
+		}
+		// A track that is left out can not be continued in the window, so the frozen tracks would be cut.
+		int numAdded = cellTrellis.WarmStart(numOld, &cellA[0], &divA[0], &deathA[0]);
+		if (numAdded != numOld) {
+			ostringstream error;
+			error << "Only " << numAdded << " of the " << numOld << " cells in images " << mFirstT << " to "
+				<< mNumT << " could be added to the online window";
+			mError = error.str();
+			lout << "Error: " << mError << "." << endl;
+			return;
+		}
+	}
+
+	Tree *tree = cellTrellis.GetTree();
+	int iter = 1;
+	while (true) {
+		tree->SetIteration(iter);
+		if (lout.IsVerbose(LogStream::VERBOSITY_ITERATIONS)) {
+			lout << "Iteration " << iter << endl;
+		}
+		if (cellTrellis.AddCell() == 0) {
+			break;
+		}
+		iter++;
+	}
+
+	int numNew = tree->GetNumCells();
+	vector<double> cellA(max(numT*numNew, 1));
+	vector<double> divA(max(2*numNew, 1));
+	vector<double> deathA(max(numNew, 1));
+	tree->GetCells(&cellA[0], &divA[0], &deathA[0]);
+
+	// Every cell in the frozen image must be continued by exactly one new cell that starts there.
+	vector<int> numFirst(mNumDets[0], 0);
+	for (int i=0; i<numNew && frozenFirst; i++) {
+		if (cellA[i*numT] != 0.0) {
+			numFirst[(int) cellA[i*numT] - 1]++;
+		}
+	}
+	if (numFirst != firstCounts) {
+		ostringstream error;
+		error << "The tracks found in images " << mFirstT << " to " << mNumT
+			<< " do not continue the frozen tracks in image " << mFirstT;
+		mError = error.str();
+		lout << "Error: " << mError << "." << endl;
+		return;
+	}
+
+	// Remove the cells that start after the frozen image and cut the other cells in the window before
+	// the window. The cut cells are continued by the new cells that start in the frozen image.
+	vector<int> keptIndices(GetNumCells(), -1);
+	int numKept = 0;
+	for (int c=0; c<GetNumCells(); c++) {
+		if (frozenFirst && mCellStarts[c] <= mFirstT) {
+			keptIndices[c] = numKept;
+			numKept++;
+		}
+	}
+	for (int c=0; c<GetNumCells(); c++) {
+		int k = keptIndices[c];
+		if (k == -1) {
+			continue;
+		}
+		mCellStarts[k] = mCellStarts[c];
+		mCellDets[k].swap(mCellDets[c]);
+		mChildren1[k] = (mChildren1[c] == -1) ? -1 : keptIndices[mChildren1[c]];
+		mChildren2[k] = (mChildren2[c] == -1) ? -1 : keptIndices[mChildren2[c]];
+		mDeaths[k] = mDeaths[c];
+	}
+	mCellStarts.resize(numKept);
+	mCellDets.resize(numKept);
+	mChildren1.resize(numKept);
+	mChildren2.resize(numKept);
+	mDeaths.resize(numKept);
+
+	vector<vector<int> > crossingCells(mNumDets[0]);  // Cut cells by their detections in the frozen image.
+	for (int c=0; c<numKept; c++) {
+		if (mCellStarts[c] + (int) mCellDets[c].size() - 1 >= mFirstT) {
+			crossingCells[mCellDets[c][mFirstT - mCellStarts[c]]].push_back(c);
+			mCellDets[c].resize(mFirstT - mCellStarts[c]);
+			mChildren1[c] = -1;
+			mChildren2[c] = -1;
+			mDeaths[c] = false;
+		}
+	}
+
+	// Add the new cells, or append them to the cut cells.
+	vector<int> numUsed(mNumDets[0], 0);
+	vector<int> cellIndices(numNew);
+	for (int i=0; i<numNew; i++) {
+		int first = 0;
+		while (cellA[i*numT+first] == 0.0) {
+			first++;
+		}
+		int c;
+		int d = (int) cellA[i*numT+first] - 1;
+		if (first == 0 && frozenFirst) {
+			c = crossingCells[d][numUsed[d]];
+			numUsed[d]++;
+		} else {
+			c = GetNumCells();
+			mCellStarts.push_back(mFirstT + first);
+			mCellDets.push_back(vector<int>());
+			mChildren1.push_back(-1);
+			mChildren2.push_back(-1);
+			mDeaths.push_back(false);
+		}
+		for (int t=first; t<numT && cellA[i*numT+t] != 0.0; t++) {
+			mCellDets[c].push_back((int) cellA[i*numT+t] - 1);
+		}
+		cellIndices[i] = c;
+	}
+	for (int i=0; i<numNew; i++) {
+		int c = cellIndices[i];
+		if (divA[i] != 0.0) {
+			mChildren1[c] = cellIndices[(int) divA[i] - 1];
+			mChildren2[c] = cellIndices[(int) divA[numNew+i] - 1];
+		}
+		mDeaths[c] = (deathA[i] != 0.0);
+	}
+
+	mLinkedT = mNumT;
+}
+
+void OnlineLinker::Freeze(int aFirstT) {
+	if (aFirstT <= mFirstT) {
+		return;
+	}
+	int numFrozen = aFirstT - mFirstT;
+	mNumDets.erase(mNumDets.begin(), mNumDets.begin() + numFrozen);
+	mCountRows.erase(mCountRows.begin(), mCountRows.begin() + numFrozen);
+	mMigRows.erase(mMigRows.begin(), mMigRows.begin() + numFrozen);
+	mMitRows.erase(mMitRows.begin(), mMitRows.begin() + numFrozen);
+	mApoRows.erase(mApoRows.begin(), mApoRows.begin() + numFrozen);
+	mAppearRows.erase(mAppearRows.begin(), mAppearRows.begin() + numFrozen);
+	mDisappearRows.erase(mDisappearRows.begin(), mDisappearRows.begin() + numFrozen);
+	mFirstT = aFirstT;
+}
+
+void OnlineLinker::GetCells(double *aCellA, double *aDivA, double *aDeathA) {
+	int numCells = GetNumCells();
+	for (int i=0; i<mNumT*numCells; i++) {
+		aCellA[i] = 0.0;
+	}
+	for (int c=0; c<numCells; c++) {
+		for (int j=0; j<(int)mCellDets[c].size(); j++) {
+			aCellA[c*mNumT + mCellStarts[c] + j - 1] = mCellDets[c][j] + 1.0;
+		}
+		aDivA[c] = (mChildren1[c] == -1) ? 0.0 : mChildren1[c] + 1.0;
+		aDivA[numCells+c] = (mChildren2[c] == -1) ? 0.0 : mChildren2[c] + 1.0;
+		aDeathA[c] = mDeaths[c] ? 1.0 : 0.0;
+	}
+}
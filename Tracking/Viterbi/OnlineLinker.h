@@ -0,0 +1,130 @@
+#ifndef ONLINELINKER
+#define ONLINELINKER
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Track linking for image sequences where the images arrive one at a time, for example while the
+// images are being acquired. The images are added to a window of images at the end of the sequence,
+// and every time the window is full, a CellTrellis is created for the images in the window and
+// CellTrellis::AddCell is called until no more cells can be added. After that, all images except the
+// last images of the window, given by the horizon, are frozen and removed from the window. The
+// scores, the Detections and the Events of the frozen images are released, and only the detection
+// indices of the cell tracks in the frozen images are kept. Therefore the memory used by the
+// trellis does not grow with the length of the image sequence.
+//
+// The first image of the window is the last frozen image. It is included so that the tracks in the
+// frozen images can continue into the window. The cells in that image are added to the new
+// CellTrellis using CellTrellis::WarmStart, together with the cells that were added to the rest
+// of the window by the previous search, and the count scores of the image are replaced by scores
+// that do not allow the number of cells in its detections to change. The tracks found in the window
+// are then joined to the frozen tracks in the first image.
+//
+// When the window is larger than the image sequence, the result is the same as if all images were
+// linked together. Otherwise, links that would require changes in the frozen images can not be
+// made, so the result is usually a bit worse.
+class OnlineLinker {
+public:
+	// Creates a linker for an image sequence without images.
+	//
+	// Inputs:
+	// aSingleIdleState - See CellTrellis::CellTrellis.
+	// aMaxCount - The maximum number of cells in a detection that count scores are given for.
+	// aMaxMigScore - See CellTrellis::CellTrellis.
+	// aWindowSize - The number of images in the window when it is linked. Must be at least 2.
+	// aHorizon - The number of images at the end of the window that are kept in the window after it
+	// has been linked. The first of them becomes the frozen first image of the next window, so the
+	// tracks can only change in the last aHorizon-1 images, and nothing is linked again if aHorizon
+	// is 1. Must be at least 1 and smaller than aWindowSize.
+	// aNumThreads - The number of threads used by the CellTrellis objects.
+	OnlineLinker(bool aSingleIdleState, int aMaxCount, double aMaxMigScore, int aWindowSize, int aHorizon,
+		int aNumThreads = 1);
+
+	// Adds the next image in the sequence and links the window if it is full. The inputs have the same
+	// format as the corresponding inputs of CellTrellis::CellTrellis, but they only contain the rows for
+	// the new image. aCountA has one row for each of the aNumDets detections, and the event matrices
+	// have the rows where the first column is the number of the new image. For migrations, mitoses,
+	// apoptoses and disappearances, this means that the events start in the new image, and for
+	// appearances it means that the events end in the new image.
+	void AddImage(int aNumDets, const double *aCountA, int aNumMigs, const double *aMigA, int aNumMits,
+		const double *aMitA, int aNumApos, const double *aApoA, int aNumAppear, const double *aAppearA,
+		int aNumDisappear, const double *aDisappearA);
+
+	// Links the images that have been added since the window was linked the last time. This should be
+	// called after the last image has been added.
+	void Finish();
+
+	// Returns a description of the error that stopped the linking, or an empty string if there was no
+	// error. No more images are linked after an error, and the tracks should not be used.
+	string GetError() const { return mError; }
+
+	// Writes the cell tracks into matrices with the same format as the outputs of Tree::GetCells. The
+	// matrices must have room for GetNumT() images and GetNumCells() cells.
+	void GetCells(double *aCellA, double *aDivA, double *aDeathA);
+
+	// Returns the number of cells in the tracks.
+	int GetNumCells() const { return (int) mCellStarts.size(); }
+
+	// Returns the number of images that have been added.
+	int GetNumT() const { return mNumT; }
+
+	// Sets the batch size of the CellTrellis objects. See CellTrellis::SetBatchSize.
+	void SetBatchSize(int aBatchSize) { mBatchSize = aBatchSize; }
+
+	// Turns lazy swaps on or off in the CellTrellis objects. See CellTrellis::SetLazySwaps.
+	void SetLazySwaps(bool aLazySwaps) { mLazySwaps = aLazySwaps; }
+
+	// Sets the minimum path score of the CellTrellis objects. See CellTrellis::SetMinScore.
+	void SetMinScore(double aMinScore) { mMinScore = aMinScore; }
+
+	// Turns windowed search on or off in the CellTrellis objects. See Trellis::SetWindowed.
+	void SetWindowed(bool aWindowed) { mWindowed = aWindowed; }
+
+private:
+	bool mSingleIdleState;
+	int mMaxCount;
+	double mMaxMigScore;
+	int mWindowSize;		// The number of images in the window when it is linked.
+	int mHorizon;			// The number of images that are kept in the window after linking.
+	int mNumThreads;
+	int mBatchSize;
+	bool mLazySwaps;
+	double mMinScore;
+	bool mWindowed;
+
+	int mNumT;				// The number of images that have been added.
+	int mFirstT;			// The number of the first image in the window, starting from 1.
+	int mLinkedT;			// The number of the last image that has been linked, or 0.
+
+	// The number of detections and the score matrix rows of the images in the window. The rows of each
+	// image are stored one after the other, with the elements of each row stored together.
+	vector<int> mNumDets;
+	vector<vector<double> > mCountRows;
+	vector<vector<double> > mMigRows;
+	vector<vector<double> > mMitRows;
+	vector<vector<double> > mApoRows;
+	vector<vector<double> > mAppearRows;
+	vector<vector<double> > mDisappearRows;
+
+	// The cell tracks. Every cell is present in the consecutive images starting at mCellStarts (counted
+	// from 1), and mCellDets holds the indices of its detections in those images, starting from 0.
+	// mChildren1 and mChildren2 are the indices of the daughter cells, or -1 if the cell does not divide.
+	vector<int> mCellStarts;
+	vector<vector<int> > mCellDets;
+	vector<int> mChildren1;
+	vector<int> mChildren2;
+	vector<bool> mDeaths;
+
+	string mError;			// See GetError.
+
+	// Creates a CellTrellis for the window, adds the cells in the window to it and calls AddCell until
+	// no more cells can be added. Then the new tracks in the window replace the old ones. If the frozen
+	// tracks can not be continued by the new tracks, mError is set and the tracks are left unchanged.
+	void Link();
+
+	// Removes the images before aFirstT from the window.
+	void Freeze(int aFirstT);
+};
+#endif
@@ -10,7 +10,7 @@ class IdleState;
 class Tree;
 
 // Event associated with cells that are present in the first image.
-class Preexist: Event {
+class Preexist: public Event {
 public:
 	// Creates a preexist event (arc) between a start-IdleState and a Detection.
 	Preexist(IdleState *aStartState, Detection *aEndDetection);
@@ -24,5 +24,8 @@ public:
 
 	// Returns the score associated with having the cell in the first image.
 	virtual double GetScore() const;
+
+	// The score only depends on the cell count of the end Detection.
+	virtual bool HasLocalScore() const { return true; }
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,29 @@
+#include "ScoreMatrix.h"
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+ScoreMatrix::ScoreMatrix(int aNumRows) : mNumRows(aNumRows) {
+}
+
+ScoreMatrix::ScoreMatrix(const double *aA, int aNumRows, int aNumCols) : mNumRows(aNumRows) {
+	for (int j=0; j<aNumCols; j++) {
+		AddColumn(aA + (size_t) j * aNumRows, DOUBLE);
+	}
+}
+
+void ScoreMatrix::AddColumn(const void *aData, Type aType) {
+	mColumns.push_back(aData);
+	mTypes.push_back(aType);
+}
+
+void ScoreMatrix::SelectRows(const vector<int> &aRows, vector<double> &aSelected) const {
+	int numSelected = (int) aRows.size();
+	aSelected.assign(max(numSelected * GetNumCols(), 1), 0.0);
+	for (int j=0; j<GetNumCols(); j++) {
+		for (int i=0; i<numSelected; i++) {
+			aSelected[j*numSelected+i] = Get(aRows[i], j);
+		}
+	}
+}
@@ -0,0 +1,74 @@
+#ifndef SCOREMATRIX
+#define SCOREMATRIX
+
+#include <vector>
+
+using namespace std;
+
+// Read-only description of a matrix with the inputs of the track linking, such as the migration
+// scores, where the columns can have different numeric types. Every column is a pointer to an
+// array of doubles, singles (floats) or 32-bit integers, so that large inputs from Matlab can be
+// used without being converted to doubles and copied when all images are linked together. Online
+// linking and linking of components copy the rows that they need into double matrices. The columns
+// hold image numbers and detection indices followed by scores, as described for
+// CellTrellis::CellTrellis. The matrix does not own the arrays, which must exist as long as the
+// matrix is used.
+class ScoreMatrix {
+public:
+	// The numeric types that a column can have.
+	enum Type {DOUBLE, SINGLE, INT32};
+
+	// Creates a matrix with aNumRows rows and no columns. The columns are added using AddColumn.
+	ScoreMatrix(int aNumRows = 0);
+
+	// Creates a matrix with the columns of the column-major double matrix aA, which has aNumRows
+	// rows and aNumCols columns.
+	ScoreMatrix(const double *aA, int aNumRows, int aNumCols);
+
+	// Adds a column to the right of the existing columns. aData must have GetNumRows() elements
+	// of the type aType.
+	void AddColumn(const void *aData, Type aType);
+
+	// Returns the element in row aRow and column aCol, converted to a double.
+	double Get(int aRow, int aCol) const {
+		const void *data = mColumns[aCol];
+		switch (mTypes[aCol]) {
+		case SINGLE:
+			return (double) ((const float *) data)[aRow];
+		case INT32:
+			return (double) ((const int *) data)[aRow];
+		default:
+			return ((const double *) data)[aRow];
+		}
+	}
+
+	// Returns the element in row aRow and column aCol, converted to an int. Used for the image
+	// numbers and the detection indices.
+	int GetInt(int aRow, int aCol) const {
+		const void *data = mColumns[aCol];
+		switch (mTypes[aCol]) {
+		case SINGLE:
+			return (int) ((const float *) data)[aRow];
+		case INT32:
+			return ((const int *) data)[aRow];
+		default:
+			return (int) ((const double *) data)[aRow];
+		}
+	}
+
+	// Returns the number of columns.
+	int GetNumCols() const { return (int) mColumns.size(); }
+
+	// Returns the number of rows.
+	int GetNumRows() const { return mNumRows; }
+
+	// Copies the rows aRows into the column-major double matrix aSelected, which always gets at
+	// least one element.
+	void SelectRows(const vector<int> &aRows, vector<double> &aSelected) const;
+
+private:
+	int mNumRows;
+	vector<const void*> mColumns;
+	vector<Type> mTypes;
+};
+#endif
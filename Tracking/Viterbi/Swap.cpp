@@ -7,8 +7,8 @@
 #include "State.h"
 #include "Tree.h"
 
-Swap::Swap(CellNode *aCell, Event *aEvent1, Event *aEvent2)
-	: Event(aEvent1->GetStartState(), aEvent2->GetEndState()), mDeleted(0) {
+Swap::Swap(CellNode *aCell, Event *aEvent1, Event *aEvent2, bool aInTrellis)
+	: Event(aEvent1->GetStartState(), aEvent2->GetEndState(), aInTrellis), mDeleted(0) {
 
 		// Set pointers.
 		mEvent1 = aEvent1;
@@ -16,7 +16,9 @@ Swap::Swap(CellNode *aCell, Event *aEvent1, Event *aEvent2)
 		mCell = aCell;
 
 		//if (!mCell->HasParent()) {
+		if (aInTrellis) {
 			mCell->AddDependentSwap(this);
+		}
 		//} else {
 		//	CellNode *child1 = mCell->GetParent()->GetChild(0);
 		//	child1->AddDependentSwap(this);
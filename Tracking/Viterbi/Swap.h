@@ -19,7 +19,9 @@ class Swap : public Event {
 	 // aCell - The second CellNode in the cell track link that will be broken.
 	 // aEvent1 - The event that will be used to link the active cell of a Tree to aCell.
 	 // aEvent2 - The event that will be used to extend the first part of the broken cell track.
-	 Swap(CellNode *aCell, Event *aEvent1, Event *aEvent2);
+	 // aInTrellis - If this is false, the swap is not an arc in the CellTrellis and it is not
+	 // deleted together with the other swaps of aCell. Such swaps are created by SwapHubs.
+	 Swap(CellNode *aCell, Event *aEvent1, Event *aEvent2, bool aInTrellis = true);
 
 	 ~Swap();
 
@@ -43,6 +45,10 @@ class Swap : public Event {
 
 	 int GetDeleted() { return mDeleted; }
 
+	 // Returns the CellNode whose track is broken by the swap. The swap is deleted when that
+	 // CellNode changes.
+	 CellNode *GetCell() const { return mCell; }
+
 private:
 	Event *mEvent1;  //The event that will be used to link the active cell of a Tree to mCell.
 	Event *mEvent2;  //The event that will be used to extend the first part of the broken cell track.
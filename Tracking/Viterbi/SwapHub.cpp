@@ -0,0 +1,51 @@
+#include "SwapHub.h"
+#include <vector>
+#include "CellNode.h"
+#include "Event.h"
+#include "State.h"
+#include "Swap.h"
+
+using namespace std;
+
+SwapHub::SwapHub(CellNode *aCell, const vector<Event*> &aEvents1, const vector<Event*> &aEvents2)
+	: mCell(aCell), mEvents1(aEvents1), mEvents2(aEvents2) {
+
+	for (int i=0; i<(int)mEvents1.size(); i++) {
+		AddEntry(mEvents1[i]->GetStartState());
+	}
+	for (int j=0; j<(int)mEvents2.size(); j++) {
+		AddExit(mEvents2[j]->GetEndState());
+	}
+	mCell->AddDependentSwap(this);
+}
+
+SwapHub::~SwapHub() {
+	for (int i=0; i<(int)mSwaps.size(); i++) {
+		delete mSwaps[i];
+	}
+}
+
+double SwapHub::GetEntryScore(int aEntry) const {
+	return mEvents1[aEntry]->GetPlusScore();
+}
+
+double SwapHub::GetExitScore(int aExit) const {
+	return mEvents2[aExit]->GetScore();
+}
+
+double SwapHub::GetScore() const {
+	return mCell->GetPrevEvent()->GetMinusScore();
+}
+
+Arc *SwapHub::CreateArc(int aEntry, int aExit) {
+	for (int i=0; i<(int)mSwaps.size(); i++) {
+		if (mSwapEntries[i] == aEntry && mSwapExits[i] == aExit) {
+			return mSwaps[i];
+		}
+	}
+	Swap *swap = new Swap(mCell, mEvents1[aEntry], mEvents2[aExit], false);
+	mSwaps.push_back(swap);
+	mSwapEntries.push_back(aEntry);
+	mSwapExits.push_back(aExit);
+	return swap;
+}
@@ -0,0 +1,50 @@
+#ifndef SWAPHUB
+#define SWAPHUB
+
+#include <vector>
+#include "Hub.h"
+
+class CellNode;
+class Event;
+class Swap;
+
+using namespace std;
+
+// Hub that represents all Swaps which break the link between a CellNode and the previous CellNode in
+// its cell track. The entries are the Events that can link the active cell of a Tree to the CellNode
+// (the first Events of the Swaps) and the exits are the Events that can extend the first part of the
+// broken cell track (the second Events of the Swaps). The score of a Swap is the plus score of the first
+// Event, plus the minus score of the broken link, plus the score of the second Event, so all combinations
+// can be represented by the hub. Swap objects are only created for the paths through the hub that are
+// returned by the Trellis. The hub is deleted together with the Swaps of the CellNode.
+class SwapHub : public Hub {
+public:
+	// Creates a hub for the Swaps of aCell. All combinations of an Event in aEvents1 and an Event in
+	// aEvents2 must be allowed swaps.
+	SwapHub(CellNode *aCell, const vector<Event*> &aEvents1, const vector<Event*> &aEvents2);
+
+	// Deletes the Swaps that have been created.
+	virtual ~SwapHub();
+
+	// Returns the plus score of the first Event.
+	virtual double GetEntryScore(int aEntry) const;
+
+	// Returns the score of the second Event.
+	virtual double GetExitScore(int aExit) const;
+
+	// Returns the score of removing the link between the CellNode and the previous CellNode.
+	virtual double GetScore() const;
+
+protected:
+	// Returns the Swap made up of entry aEntry and exit aExit. The Swap is only created once.
+	virtual Arc *CreateArc(int aEntry, int aExit);
+
+private:
+	CellNode *mCell;			// The second CellNode in the cell track link that will be broken.
+	vector<Event*> mEvents1;	// The first Events of the Swaps.
+	vector<Event*> mEvents2;	// The second Events of the Swaps.
+	vector<Swap*> mSwaps;		// The Swaps that have been created.
+	vector<int> mSwapEntries;	// The entries of the Swaps in mSwaps.
+	vector<int> mSwapExits;		// The exits of the Swaps in mSwaps.
+};
+#endif
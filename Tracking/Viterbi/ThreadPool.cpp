@@ -0,0 +1,92 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+using namespace std;
+
+ThreadPool::ThreadPool(int aNumThreads)
+	: mFunction(NULL), mN(0), mChunk(1), mNext(0), mLoop(0), mNumBusy(0), mStop(false) {
+
+	int numThreads = aNumThreads;
+	if (numThreads < 1) {
+		numThreads = max((int) thread::hardware_concurrency(), 1);
+	}
+	for (int i=0; i<numThreads-1; i++) {
+		mWorkers.push_back(thread(&ThreadPool::Work, this));
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		lock_guard<mutex> lock(mMutex);
+		mStop = true;
+	}
+	mStart.notify_all();
+	for (int i=0; i<(int)mWorkers.size(); i++) {
+		mWorkers[i].join();
+	}
+}
+
+void ThreadPool::ParallelFor(int aN, int aChunk, const function<void(int, int)> &aFunction) {
+	if (mWorkers.empty() || aN <= aChunk) {
+		// Starting the workers would cost more than it saves.
+		if (aN > 0) {
+			aFunction(0, aN);
+		}
+		return;
+	}
+
+	{
+		lock_guard<mutex> lock(mMutex);
+		mFunction = &aFunction;
+		mN = aN;
+		mChunk = aChunk;
+		mNext = 0;
+		mNumBusy = (int) mWorkers.size();
+		mLoop++;
+	}
+	mStart.notify_all();
+
+	RunChunks();
+
+	unique_lock<mutex> lock(mMutex);
+	while (mNumBusy > 0) {
+		mDone.wait(lock);
+	}
+	mFunction = NULL;
+}
+
+void ThreadPool::RunChunks() {
+	while (true) {
+		int begin = mNext.fetch_add(mChunk);
+		if (begin >= mN) {
+			break;
+		}
+		(*mFunction)(begin, min(begin + mChunk, mN));
+	}
+}
+
+void ThreadPool::Work() {
+	int loop = 0;  // The last loop that this worker took part in.
+	while (true) {
+		{
+			unique_lock<mutex> lock(mMutex);
+			while (!mStop && mLoop == loop) {
+				mStart.wait(lock);
+			}
+			if (mStop) {
+				return;
+			}
+			loop = mLoop;
+		}
+
+		RunChunks();
+
+		{
+			lock_guard<mutex> lock(mMutex);
+			mNumBusy--;
+			if (mNumBusy == 0) {
+				mDone.notify_one();
+			}
+		}
+	}
+}
@@ -0,0 +1,53 @@
+#ifndef THREADPOOL
+#define THREADPOOL
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// A fixed set of worker threads that can be used to run loops in parallel. The thread that calls
+// ParallelFor also takes part in the work, so a pool with N threads starts N-1 worker threads.
+// The workers sleep between calls to ParallelFor. Only one thread may call ParallelFor at a time.
+class ThreadPool {
+public:
+	// Creates a pool that runs loops on aNumThreads threads. If aNumThreads is smaller than 1,
+	// the number of threads is set to the number of cores in the computer.
+	ThreadPool(int aNumThreads);
+
+	// Stops and joins the worker threads.
+	~ThreadPool();
+
+	// Returns the number of threads that the loops are run on, including the calling thread.
+	int GetNumThreads() const { return (int) mWorkers.size() + 1; }
+
+	// Calls aFunction(begin, end) for chunks [begin, end) that together cover [0, aN). The
+	// chunks contain aChunk elements, except the last one, and they are processed in an
+	// undefined order by the different threads. The function returns when all chunks are done.
+	void ParallelFor(int aN, int aChunk, const function<void(int, int)> &aFunction);
+
+private:
+	vector<thread> mWorkers;	// Worker threads.
+	mutex mMutex;				// Protects the members below that are not atomic.
+	condition_variable mStart;	// Signals that a new loop has been started or that the pool is stopping.
+	condition_variable mDone;	// Signals that all workers are done with the current loop.
+
+	const function<void(int, int)> *mFunction;	// Body of the current loop.
+	int mN;						// Number of iterations in the current loop.
+	int mChunk;					// Number of iterations per chunk in the current loop.
+	atomic<int> mNext;			// First iteration of the next chunk that has not been started.
+	int mLoop;					// Counter that is incremented every time a loop is started.
+	int mNumBusy;				// The number of workers that have not finished the current loop.
+	bool mStop;					// True when the workers should exit.
+
+	// Processes chunks of the current loop until there are no chunks left.
+	void RunChunks();
+
+	// Main function of the worker threads.
+	void Work();
+};
+#endif
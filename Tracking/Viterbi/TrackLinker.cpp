@@ -0,0 +1,278 @@
+#include "TrackLinker.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>  // To get NULL.
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "ArraySave.h"
+#include "CellTrellis.h"
+#include "ComponentLinker.h"
+#include "LogStream.h"
+#include "OnlineLinker.h"
+#include "ScoreMatrix.h"
+#include "Tree.h"
+
+using namespace std;
+
+// Groups the rows of aA by the image number in the first column. aRows[t] gets the indices of the
+// rows of image t+1.
+static void GroupRows(const ScoreMatrix &aA, int aNumT, vector<vector<int> > &aRows) {
+	aRows.assign(aNumT, vector<int>());
+	for (int i=0; i<aA.GetNumRows(); i++) {
+		aRows[aA.GetInt(i, 0) - 1].push_back(i);
+	}
+}
+
+// Returns the total number of detections in the aNumT images.
+static int NumDetections(int aNumT, const double *aNumTDets) {
+	int numDets = 0;
+	for (int t=0; t<aNumT; t++) {
+		numDets += (int) aNumTDets[t];
+	}
+	return numDets;
+}
+
+TrackLinker::TrackLinker(bool aSingleIdleState, int aNumT, int aMaxCount, int aNumMigs, int aNumMits, int aNumApos,
+	int aNumAppear, int aNumDisappear, double *aNumTDets, double *aCountA, double *aMigA, double *aMitA,
+	double *aApoA, double *aAppearA, double *aDisappearA, double aMaxMigScore)
+	: TrackLinker(aSingleIdleState, aNumT, aMaxCount, aNumTDets, ScoreMatrix(aCountA, NumDetections(aNumT, aNumTDets), aMaxCount+3),
+	ScoreMatrix(aMigA, aNumMigs, 5), ScoreMatrix(aMitA, aNumMits, 6), ScoreMatrix(aApoA, aNumApos, 4),
+	ScoreMatrix(aAppearA, aNumAppear, 4), ScoreMatrix(aDisappearA, aNumDisappear, 4), aMaxMigScore) {
+}
+
+TrackLinker::TrackLinker(bool aSingleIdleState, int aNumT, int aMaxCount, const double *aNumTDets,
+	const ScoreMatrix &aCount, const ScoreMatrix &aMig, const ScoreMatrix &aMit, const ScoreMatrix &aApo,
+	const ScoreMatrix &aAppear, const ScoreMatrix &aDisappear, double aMaxMigScore)
+	: mSingleIdleState(aSingleIdleState), mNumT(aNumT), mMaxCount(aMaxCount), mNumTDets(aNumTDets), mCount(aCount),
+	mMig(aMig), mMit(aMit), mApo(aApo), mAppear(aAppear), mDisappear(aDisappear), mMaxMigScore(aMaxMigScore),
+	mNumThreads(1), mWindowed(false), mBatchSize(1), mLazySwaps(false), mMinScore(0), mMaxIterations(0),
+	mTimeBudget(0), mOnlineWindow(0), mOnlineHorizon(0), mDecompose(false), mNumWarmCells(0), mWarmCellA(NULL),
+	mWarmDivA(NULL), mWarmDeathA(NULL), mNumCells(0) {
+}
+
+string TrackLinker::CheckSettings() const {
+	if (mOnlineWindow > 0 && (mOnlineWindow < 2 || mOnlineHorizon < 1 || mOnlineHorizon >= mOnlineWindow)) {
+		return "The online window must have at least 2 images and the horizon must be between 1 and the window size";
+	}
+	if (mOnlineWindow > 0 && mWarmCellA != NULL) {
+		return "A previous tracking result can not be used in online linking";
+	}
+	if (mDecompose && (mOnlineWindow > 0 || mWarmCellA != NULL)) {
+		return "Decomposition into components can not be combined with online linking or a previous tracking result";
+	}
+	if (mMinScore < 0) {
+		return "The minimum score of an added cell can not be negative";
+	}
+	if ((mMaxIterations > 0 || mTimeBudget > 0) && (mOnlineWindow > 0 || mDecompose)) {
+		return "Iteration and time limits can only be used when all images are linked together";
+	}
+	return "";
+}
+
+void TrackLinker::GetCells(double *aCellA, double *aDivA, double *aDeathA) {
+	copy(mCellA.begin(), mCellA.begin() + mNumT*mNumCells, aCellA);
+	copy(mDivA.begin(), mDivA.begin() + 2*mNumCells, aDivA);
+	copy(mDeathA.begin(), mDeathA.begin() + mNumCells, aDeathA);
+}
+
+void TrackLinker::Link() {
+	mTrace.clear();
+	mError.clear();
+	if (mOnlineWindow > 0) {
+		LinkOnline();
+	} else if (mDecompose) {
+		LinkComponents();
+	} else {
+		LinkAll();
+	}
+}
+
+void TrackLinker::SetOnline(int aWindowSize, int aHorizon) {
+	mOnlineWindow = aWindowSize;
+	mOnlineHorizon = (aHorizon < 1) ? aWindowSize / 2 : aHorizon;
+}
+
+void TrackLinker::SetWarmStart(int aNumCells, const double *aCellA, const double *aDivA, const double *aDeathA) {
+	mNumWarmCells = aNumCells;
+	mWarmCellA = aCellA;
+	mWarmDivA = aDivA;
+	mWarmDeathA = aDeathA;
+}
+
+void TrackLinker::LinkAll() {
+	// Create a trellis graph that will be used to solve the tracknig problem.
+	CellTrellis cellTrellis(mSingleIdleState, mNumT, mMaxCount, mNumTDets, mCount, mMig, mMit, mApo, mAppear,
+		mDisappear, mMaxMigScore, mNumThreads);
+	cellTrellis.SetWindowed(mWindowed);
+	cellTrellis.SetBatchSize(mBatchSize);
+	cellTrellis.SetLazySwaps(mLazySwaps);
+	cellTrellis.SetMinScore(mMinScore);
+
+	// Add cells iteratively until as long as the score increases.
+	int iter = 1;
+	int addedCells = 0;
+	Tree *tree = cellTrellis.GetTree();
+
+	// Cells from a previous result get the iteration number 0.
+	if (mWarmCellA != NULL) {
+		tree->SetIteration(0);
+		if (lout.IsVerbose(LogStream::VERBOSITY_SUMMARY)) {
+			lout << "Adding cells from a previous tracking result." << endl;
+		}
+		cellTrellis.WarmStart(mNumWarmCells, mWarmCellA, mWarmDivA, mWarmDeathA);
+	}
+
+	// Start a new log of the iterations.
+	if (!mIterationPath.empty()) {
+		remove((mIterationPath + "/iterations.bin").c_str());
+		mSavedRecords.clear();
+		tree->SetRecordChanges(true);
+	}
+
+	chrono::steady_clock::time_point linkStart = chrono::steady_clock::now();
+	while (true) {
+		if (mMaxIterations > 0 && iter > mMaxIterations) {
+			if (lout.IsVerbose(LogStream::VERBOSITY_SUMMARY)) {
+				lout << "Stopping after " << mMaxIterations << " iterations." << endl << endl;
+			}
+			break;
+		}
+		if (mTimeBudget > 0 && chrono::duration<double>(chrono::steady_clock::now() - linkStart).count() >= mTimeBudget) {
+			if (lout.IsVerbose(LogStream::VERBOSITY_SUMMARY)) {
+				lout << "Stopping because the time budget has been used." << endl << endl;
+			}
+			break;
+		}
+
+		tree->SetIteration(iter);
+		if (lout.IsVerbose(LogStream::VERBOSITY_ITERATIONS)) {
+			lout << "Iteration " << iter << endl;
+		}
+		int numCreatedSwaps = cellTrellis.GetNumCreatedSwaps();
+		int numDeletedSwaps = cellTrellis.GetNumDeletedSwaps();
+		chrono::steady_clock::time_point iterStart = chrono::steady_clock::now();
+		addedCells = cellTrellis.AddCell();
+		double iterTime = chrono::duration<double>(chrono::steady_clock::now() - iterStart).count();
+
+		double traceRow[NUM_TRACE_COLUMNS] = {(double) iter, (double) addedCells, cellTrellis.GetAddedScore(),
+			cellTrellis.GetSearchTime(), iterTime, (double) (cellTrellis.GetNumCreatedSwaps() - numCreatedSwaps),
+			(double) (cellTrellis.GetNumDeletedSwaps() - numDeletedSwaps), (double) tree->GetNumCells()};
+		mTrace.insert(mTrace.end(), traceRow, traceRow + NUM_TRACE_COLUMNS);
+
+		// No modifications were made in the last iteration.
+		if (addedCells == 0) {
+			break;
+		}
+
+		if (!mIterationPath.empty()) {
+			SaveIteration(cellTrellis, iter);
+		}
+
+		iter++;
+	}
+
+	if (lout.IsVerbose(LogStream::VERBOSITY_EVENTS)) {
+		tree->Print();
+		lout << endl;  // Empty line after all outputs.
+	}
+
+	mNumCells = tree->GetNumCells();
+	mCellA.resize(max(mNumT*mNumCells, 1));
+	mDivA.resize(max(2*mNumCells, 1));
+	mDeathA.resize(max(mNumCells, 1));
+	tree->GetCells(&mCellA[0], &mDivA[0], &mDeathA[0]);
+}
+
+void TrackLinker::LinkOnline() {
+	OnlineLinker linker(mSingleIdleState, mMaxCount, mMaxMigScore, mOnlineWindow, mOnlineHorizon, mNumThreads);
+	linker.SetWindowed(mWindowed);
+	linker.SetBatchSize(mBatchSize);
+	linker.SetLazySwaps(mLazySwaps);
+	linker.SetMinScore(mMinScore);
+
+	vector<vector<int> > countRows, migRows, mitRows, apoRows, appearRows, disappearRows;
+	GroupRows(mCount, mNumT, countRows);
+	GroupRows(mMig, mNumT, migRows);
+	GroupRows(mMit, mNumT, mitRows);
+	GroupRows(mApo, mNumT, apoRows);
+	GroupRows(mAppear, mNumT, appearRows);
+	GroupRows(mDisappear, mNumT, disappearRows);
+
+	// Give the images to the OnlineLinker one at a time, as if they were being acquired.
+	vector<double> count, mig, mit, apo, appear, disappear;
+	for (int t=0; t<mNumT; t++) {
+		mCount.SelectRows(countRows[t], count);
+		mMig.SelectRows(migRows[t], mig);
+		mMit.SelectRows(mitRows[t], mit);
+		mApo.SelectRows(apoRows[t], apo);
+		mAppear.SelectRows(appearRows[t], appear);
+		mDisappear.SelectRows(disappearRows[t], disappear);
+		linker.AddImage((int) mNumTDets[t], &count[0], (int) migRows[t].size(), &mig[0],
+			(int) mitRows[t].size(), &mit[0], (int) apoRows[t].size(), &apo[0],
+			(int) appearRows[t].size(), &appear[0], (int) disappearRows[t].size(), &disappear[0]);
+	}
+	linker.Finish();
+	mError = linker.GetError();
+
+	mNumCells = linker.GetNumCells();
+	mCellA.resize(max(mNumT*mNumCells, 1));
+	mDivA.resize(max(2*mNumCells, 1));
+	mDeathA.resize(max(mNumCells, 1));
+	linker.GetCells(&mCellA[0], &mDivA[0], &mDeathA[0]);
+}
+
+void TrackLinker::LinkComponents() {
+	ComponentLinker linker(mSingleIdleState, mNumT, mMaxCount, mNumTDets, mCount, mMig, mMit, mApo, mAppear,
+		mDisappear, mMaxMigScore, mNumThreads);
+	linker.SetWindowed(mWindowed);
+	linker.SetBatchSize(mBatchSize);
+	linker.SetLazySwaps(mLazySwaps);
+	linker.SetMinScore(mMinScore);
+	linker.Link();
+
+	mNumCells = linker.GetNumCells();
+	mCellA.resize(max(mNumT*mNumCells, 1));
+	mDivA.resize(max(2*mNumCells, 1));
+	mDeathA.resize(max(mNumCells, 1));
+	linker.GetCells(&mCellA[0], &mDivA[0], &mDeathA[0]);
+}
+
+// Save tracking matrices after each iterations, so that the algorithm steps
+// can be looked at later. The Tree records which cells it has changed, so only
+// the records of those cells are recomputed. All records are recomputed if cells
+// have been removed, because that changes the indices of the following cells.
+void TrackLinker::SaveIteration(CellTrellis &aCellTrellis, int aIter) {
+	Tree *tree = aCellTrellis.GetTree();
+	int numCells = tree->GetNumCells();
+
+	vector<int> indices;
+	if (!tree->GetChangedCells(indices) || mSavedRecords.empty()) {
+		indices.resize(numCells);
+		for (int c=0; c<numCells; c++) {
+			indices[c] = c;
+		}
+	}
+
+	// One record per cell, with the detection indices, the iterations when the cell was created
+	// in the different images, the daughter cells and the death indicator.
+	int recordLength = 2*mNumT + 3;
+	int numPrevious = (int) mSavedRecords.size() / recordLength;
+	mSavedRecords.resize(numCells*recordLength);
+	vector<double> record(recordLength);
+	vector<int> changed;
+	vector<double> changedRecords;
+	for (int i=0; i<(int)indices.size(); i++) {
+		int c = indices[i];
+		tree->GetCell(c, &record[0], &record[mNumT], &record[2*mNumT], &record[2*mNumT+2]);
+		double *saved = &mSavedRecords[c*recordLength];
+		if (c >= numPrevious || !equal(record.begin(), record.end(), saved)) {
+			copy(record.begin(), record.end(), saved);
+			changed.push_back(c);
+			changedRecords.insert(changedRecords.end(), record.begin(), record.end());
+		}
+	}
+
+	ArraySave::AppendRecords(mIterationPath + "/iterations.bin", aIter, recordLength, numCells, changed,
+		changedRecords);
+}
@@ -0,0 +1,164 @@
+#ifndef TRACKLINKER
+#define TRACKLINKER
+
+#include <string>
+#include <vector>
+#include "ScoreMatrix.h"
+
+class CellTrellis;
+
+using namespace std;
+
+// Plain C++ interface to the track linking, which does not depend on Matlab. The class takes the
+// score matrices of a tracking problem and links the detections into cell tracks. By default, all
+// images are linked together in a single CellTrellis, by calling CellTrellis::AddCell until no more
+// cells can be added. The setters can instead select online linking in a sliding window, using an
+// OnlineLinker, or linking of independent components, using a ComponentLinker. The mex-file
+// ViterbiTrackLinking and the standalone executable which is compiled from the same source file are
+// thin wrappers around this class.
+class TrackLinker {
+public:
+	// The number of columns in the trace of the iterations. See GetTrace.
+	static const int NUM_TRACE_COLUMNS = 8;
+
+	// Creates a linker for the tracking problem defined by the inputs, which are the same as the
+	// inputs of CellTrellis::CellTrellis. The input arrays are not copied and must exist until
+	// Link has been called.
+	TrackLinker(bool aSingleIdleState, int aNumT, int aMaxCount, int aNumMigs, int aNumMits, int aNumApos,
+		int aNumAppear, int aNumDisappear, double *aNumTDets, double *aCountA, double *aMigA, double *aMitA,
+		double *aApoA, double *aAppearA, double *aDisappearA, double aMaxMigScore);
+
+	// Creates a linker for a tracking problem where the columns of the inputs can have other types
+	// than double. The inputs are the same as the inputs of the CellTrellis constructor that takes
+	// ScoreMatrix objects. The arrays that the matrices point to are not copied and must exist
+	// until Link has been called.
+	TrackLinker(bool aSingleIdleState, int aNumT, int aMaxCount, const double *aNumTDets,
+		const ScoreMatrix &aCount, const ScoreMatrix &aMig, const ScoreMatrix &aMit, const ScoreMatrix &aApo,
+		const ScoreMatrix &aAppear, const ScoreMatrix &aDisappear, double aMaxMigScore);
+
+	// Returns a description of the first problem with the settings, or an empty string if the
+	// settings can be used together. Link should only be called if the string is empty.
+	string CheckSettings() const;
+
+	// Writes the cell tracks into matrices with the same format as the outputs of Tree::GetCells. The
+	// matrices must have room for the images and GetNumCells() cells.
+	void GetCells(double *aCellA, double *aDivA, double *aDeathA);
+
+	// Returns a description of the error that stopped Link, or an empty string if there was no error.
+	// The tracks should not be used if there was an error.
+	string GetError() const { return mError; }
+
+	// Returns the number of cells in the tracks.
+	int GetNumCells() const { return mNumCells; }
+
+	// Returns the number of iterations in the trace.
+	int GetNumTraceRows() const { return (int) mTrace.size() / NUM_TRACE_COLUMNS; }
+
+	// Returns statistics of the iterations, with NUM_TRACE_COLUMNS values per iteration, stored one
+	// iteration after the other. The values are the iteration number, the number of added cells,
+	// the added score, the time in seconds spent searching for the highest scoring path, the time of
+	// the whole iteration, the numbers of swaps that were created and deleted, and the number of
+	// cells in the tree after the iteration. The trace is empty in online linking and when the
+	// problem is decomposed into components.
+	const vector<double> &GetTrace() const { return mTrace; }
+
+	// Links the tracks.
+	void Link();
+
+	// Sets the batch size. See CellTrellis::SetBatchSize.
+	void SetBatchSize(int aBatchSize) { mBatchSize = aBatchSize; }
+
+	// Turns linking of independent components in a ComponentLinker on or off.
+	void SetDecompose(bool aDecompose) { mDecompose = aDecompose; }
+
+	// Sets a folder where the tracks are saved after every iteration, in the log file iterations.bin.
+	// Only the cells that changed in an iteration are saved, in the format of ArraySave::AppendChanges,
+	// and the tracks after any iteration can be reconstructed using ArraySave::ReadChanges. The Tree
+	// records the changed cells, so the other cells are not looked at. There is one
+	// record per cell, which has a column of the cell matrix from Tree::GetCells, the corresponding
+	// column from Tree::GetIterations, the two daughter cells and the death indicator. The default is
+	// an empty string, which means that nothing is saved.
+	void SetIterationPath(string aIterationPath) { mIterationPath = aIterationPath; }
+
+	// Turns lazy swaps on or off. See CellTrellis::SetLazySwaps.
+	void SetLazySwaps(bool aLazySwaps) { mLazySwaps = aLazySwaps; }
+
+	// Sets the maximum number of iterations. The default is 0, which means that there is no limit.
+	void SetMaxIterations(int aMaxIterations) { mMaxIterations = aMaxIterations; }
+
+	// Sets the minimum path score. See CellTrellis::SetMinScore.
+	void SetMinScore(double aMinScore) { mMinScore = aMinScore; }
+
+	// Sets the number of threads. See CellTrellis::CellTrellis and ComponentLinker::ComponentLinker.
+	void SetNumThreads(int aNumThreads) { mNumThreads = aNumThreads; }
+
+	// Turns online linking on if aWindowSize is larger than 0. See OnlineLinker::OnlineLinker.
+	// Values of aHorizon that are smaller than 1 give half of the window size.
+	void SetOnline(int aWindowSize, int aHorizon);
+
+	// Sets a time budget in seconds. No new iteration is started after the budget has been used.
+	// The default is 0, which means that there is no limit.
+	void SetTimeBudget(double aTimeBudget) { mTimeBudget = aTimeBudget; }
+
+	// Makes the linking start from a previous tracking result. See CellTrellis::WarmStart. The
+	// arrays are not copied and must exist until Link has been called.
+	void SetWarmStart(int aNumCells, const double *aCellA, const double *aDivA, const double *aDeathA);
+
+	// Turns windowed search on or off. See Trellis::SetWindowed.
+	void SetWindowed(bool aWindowed) { mWindowed = aWindowed; }
+
+private:
+	bool mSingleIdleState;
+	int mNumT;
+	int mMaxCount;
+	const double *mNumTDets;
+	ScoreMatrix mCount;
+	ScoreMatrix mMig;
+	ScoreMatrix mMit;
+	ScoreMatrix mApo;
+	ScoreMatrix mAppear;
+	ScoreMatrix mDisappear;
+	double mMaxMigScore;
+
+	int mNumThreads;
+	bool mWindowed;
+	int mBatchSize;
+	bool mLazySwaps;
+	double mMinScore;
+	int mMaxIterations;
+	double mTimeBudget;
+	string mIterationPath;
+	int mOnlineWindow;		// The window size in online linking, or 0.
+	int mOnlineHorizon;
+	bool mDecompose;
+
+	// The previous tracking result that the linking starts from, if mWarmCellA is not NULL.
+	int mNumWarmCells;
+	const double *mWarmCellA;
+	const double *mWarmDivA;
+	const double *mWarmDeathA;
+
+	// The outputs of Link.
+	int mNumCells;
+	vector<double> mCellA;
+	vector<double> mDivA;
+	vector<double> mDeathA;
+	vector<double> mTrace;
+	string mError;
+
+	// The records that were saved in the last iteration. See SetIterationPath.
+	vector<double> mSavedRecords;
+
+	// Links all images in a single CellTrellis.
+	void LinkAll();
+
+	// Links the images in an OnlineLinker, giving it one image at a time.
+	void LinkOnline();
+
+	// Links the independent components in a ComponentLinker.
+	void LinkComponents();
+
+	// Appends the cells in aCellTrellis that changed in iteration aIter to the log in mIterationPath.
+	void SaveIteration(CellTrellis &aCellTrellis, int aIter);
+};
+#endif
@@ -1,4 +1,5 @@
 #include "Tree.h"
+#include <algorithm>
 #include <cstddef>  // To get NULL.
 #include <map>
 #include <stdio.h>
@@ -11,7 +12,7 @@
 
 using namespace std;
 
-Tree::Tree(int aNumT) : mNumT(aNumT), mIteration(1) {
+Tree::Tree(int aNumT) : mNumT(aNumT), mIteration(1), mRecordChanges(false), mCellsRemoved(false) {
 	mActiveCell = NULL;
 }
 
@@ -32,16 +33,26 @@ CellNode *Tree::CreateCellFirst(IdleState *aState) {
 	CellNode *cell = new CellNode((State*) aState, mIteration);  // Deleted in destructor.
 	mFirstCells.push_back(cell);
 	mActiveCell = cell;
+	if (mRecordChanges) {
+		mFirstIndices[cell] = (int) mFirstCells.size() - 1;
+		mChangedCells.push_back(cell);
+	}
 	return cell;
 }
 
 CellNode *Tree::CreateCellLink(CellNode *aLinkCell, Event *aEvent) {
 	CellNode *newCell = new CellNode(aEvent->GetEndState(), mIteration);  // Deleted in destructor.
-	aLinkCell->AddLink(aEvent, newCell);
+	aLinkCell->AddLink(this, aEvent, newCell);
 	mActiveCell = newCell;
 	return newCell;
 }
 
+void Tree::DeleteCell(CellNode *aCell) {
+	assert(!aCell->HasPrevCell() && !aCell->HasNextCell());
+	mChangedCells.erase(remove(mChangedCells.begin(), mChangedCells.end(), aCell), mChangedCells.end());
+	delete aCell;
+}
+
 // Writes the Tree information directly into the memory of Matlab variables.
 void Tree::GetCells(double *aCellA, double *aDivA, double *aDeathA) {
 
@@ -105,6 +116,78 @@ void Tree::GetCells(double *aCellA, double *aDivA, double *aDeathA) {
 	}
 }
 
+void Tree::GetCell(int aIndex, double *aCellA, double *aIterationA, double *aDivA, double *aDeath) {
+	for (int t=0; t<mNumT; t++) {
+		aCellA[t] = 0.0;
+		aIterationA[t] = -1.0;
+	}
+	aDivA[0] = 0.0;
+	aDivA[1] = 0.0;
+	*aDeath = 0.0;
+
+	// The same traversal as in GetCells and GetIterations.
+	CellNode *cell = mFirstCells[aIndex]->GetNextCell();
+	while (true) {
+		State *state = cell->GetState();
+		aCellA[state->GetT()-1] = double(state->GetIndex()) + 1.0;
+		aIterationA[state->GetT()-1] = (double) cell->GetIteration();
+		CellNode *nextCell = cell->GetNextCell();
+		if (cell->HasChildren() || (!nextCell->HasNextCell() && !nextCell->HasChildren())) {
+			break;
+		}
+		cell = nextCell;
+	}
+
+	if (cell->HasChildren()) {
+		aDivA[0] = double(mFirstIndices[cell->GetChild(0)->GetPrevCell()]) + 1.0;
+		aDivA[1] = double(mFirstIndices[cell->GetChild(1)->GetPrevCell()]) + 1.0;
+	}
+	if (dynamic_cast<Apoptosis*> (cell->GetNextEvent()) != NULL) {
+		*aDeath = 1.0;
+	}
+}
+
+// The cell tracks that contain the changed CellNodes are found by following the links backwards to
+// the beginnings of the tracks. The nodes that have been passed are remembered, so that every track
+// is only followed once.
+bool Tree::GetChangedCells(vector<int> &aIndices) {
+	aIndices.clear();
+	if (mCellsRemoved) {
+		mChangedCells.clear();
+		mCellsRemoved = false;
+		mFirstIndices.clear();
+		for (int i=0; i<(int)mFirstCells.size(); i++) {
+			mFirstIndices[mFirstCells[i]] = i;
+		}
+		return false;
+	}
+
+	map<CellNode*,CellNode*> firstCells;  // The first CellNode in the track of every passed node.
+	vector<CellNode*> passed;
+	for (int i=0; i<(int)mChangedCells.size(); i++) {
+		CellNode *cell = mChangedCells[i];
+		passed.clear();
+		while (firstCells.count(cell) == 0 && cell->HasPrevCell()) {
+			passed.push_back(cell);
+			cell = cell->GetPrevCell();
+		}
+		CellNode *first = (firstCells.count(cell) > 0) ? firstCells[cell] : cell;
+		firstCells[cell] = first;
+		for (int j=0; j<(int)passed.size(); j++) {
+			firstCells[passed[j]] = first;
+		}
+		map<CellNode*,int>::iterator it = mFirstIndices.find(first);
+		if (it != mFirstIndices.end()) {
+			aIndices.push_back(it->second);
+		}
+	}
+	mChangedCells.clear();
+
+	sort(aIndices.begin(), aIndices.end());
+	aIndices.erase(unique(aIndices.begin(), aIndices.end()), aIndices.end());
+	return true;
+}
+
 void Tree::GetIterations(double *aIterationA) {
 
 	// Fill the matrix with -1.
@@ -176,8 +259,23 @@ void Tree::RemoveFirstCell(CellNode* aCell){
 		if (mFirstCells[i] == aCell) {
 			mFirstCells.erase(mFirstCells.begin()+i);
 			delete aCell;
+			if (mRecordChanges) {
+				// The indices are recomputed in GetChangedCells.
+				mCellsRemoved = true;
+				mChangedCells.clear();
+			}
 			return;
 		}
 	}
 	assert(false);
+}
+
+void Tree::SetRecordChanges(bool aRecordChanges) {
+	mRecordChanges = aRecordChanges;
+	mCellsRemoved = false;
+	mChangedCells.clear();
+	mFirstIndices.clear();
+	for (int i=0; i<(int)mFirstCells.size() && mRecordChanges; i++) {
+		mFirstIndices[mFirstCells[i]] = i;
+	}
 }
\ No newline at end of file
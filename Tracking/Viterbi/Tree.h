@@ -2,6 +2,7 @@
 #define TREE
 
 #include <cstddef>  // To get NULL.
+#include <map>
 #include <vector>
 
 class CellNode;
@@ -42,6 +43,10 @@ public:
 	// The new CellNode will be linked to the previous one by the Event aEvent.
 	CellNode *CreateCellLink(CellNode *aLinkCell, Event *aEvent);
 
+	// Deletes a CellNode that is not linked to any other CellNode and is not the
+	// beginning of a cell track.
+	void DeleteCell(CellNode *aCell);
+
 	// Returns a pointer to the cell that is currently under construction.
 	CellNode* GetActiveCell() { return mActiveCell; }
 
@@ -65,6 +70,17 @@ public:
 	// Does not handle cells that enter and leave the field of view.
 	void GetCells(double* aCellA, double* aDivA, double* aDeathA);
 
+	// Writes column aIndex of the matrices from GetCells and GetIterations into aCellA and
+	// aIterationA, the two daughter cells into aDivA and the death indicator into aDeath.
+	// Can only be used when changes are recorded, after GetChangedCells has been called.
+	void GetCell(int aIndex, double *aCellA, double *aIterationA, double *aDivA, double *aDeath);
+
+	// Writes the indices of the cells in GetCells that may have changed since the last call, or
+	// since SetRecordChanges was called, into aIndices, in increasing order. Returns false if
+	// cells have been removed, so that the indices of the remaining cells have changed. Then
+	// aIndices is empty and all cells have to be treated as changed.
+	bool GetChangedCells(vector<int> &aIndices);
+
 	// Returns an iterator pointing to the the position after the last cell chain beginning.
 	Tree::CellIterator GetEndFirstCell() { return mFirstCells.end(); }
 
@@ -78,6 +94,10 @@ public:
 	// Returns true if there is a cell under construction.
 	bool HasActiveCell() { return mActiveCell != NULL; }
 
+	// Records that the links of aCell are changed, if changes are recorded. Called by the
+	// CellNodes when they are linked and unlinked.
+	void MarkChanged(CellNode *aCell) { if (mRecordChanges) mChangedCells.push_back(aCell); }
+
 	// Prints the matrices generated by GetCells, to the command window.
 	void Print();
 
@@ -89,11 +109,21 @@ public:
 
 	void SetIteration(int aIteration) { mIteration = aIteration; }
 
+	// Turns recording of the CellNodes that change on or off. See GetChangedCells. The
+	// default is off. Turning it on costs a little time for every change of the tree.
+	void SetRecordChanges(bool aRecordChanges);
+
 private:
 	// The number of images in the image sequence. Used to produce the right matrices in GetCells.
 	int mNumT;
 	int mIteration;					// The current tracking iteration. Used to give cells the correct iteration number.
 	vector<CellNode*> mFirstCells;  // Starting nodes in all cell tracks.
 	CellNode *mActiveCell;			// Cell node that we are currently adding more cell nodes to.
+
+	// Recording of changes. See GetChangedCells.
+	bool mRecordChanges;
+	bool mCellsRemoved;					// True if cells have been removed since the last GetChangedCells.
+	vector<CellNode*> mChangedCells;	// CellNodes with changed links, which can contain duplicates.
+	map<CellNode*,int> mFirstIndices;	// Indices of the nodes in mFirstCells, when changes are recorded.
 };
 #endif
\ No newline at end of file
@@ -1,35 +1,263 @@
+#include <algorithm>
+#include <cmath>
 #include <cstddef>  // To get NULL.
+#include <functional>
 #include <limits>
 #include <list>
 #include <vector>
 #include "Trellis.h"
+#include "Arena.h"
 #include "Arc.h"
+#include "Hub.h"
+#include "LogStream.h"
 #include "Node.h"
+#include "ThreadPool.h"
 
 using namespace std;
 
 // Default constructor used to make it possible to inherit from the class.
-Trellis::Trellis(int aNumT) : mNumT(aNumT) {
+Trellis::Trellis(int aNumT)
+	: mNumT(aNumT), mLayerOffsets(aNumT+1, 0), mArcOffsets(aNumT), mArcStarts(aNumT), mArcs(aNumT),
+	mArcsChanged(aNumT, true), mArcScores(aNumT), mArcLocal(aNumT), mScoresChanged(aNumT, false),
+	mHubs(aNumT), mNumHubHoles(aNumT, 0), mIncremental(true), mVerify(false), mWindowed(false), mChangedLayer(1), mLastChangedLayer(aNumT-1),
+	mForwardValid(1), mBackwardValid(aNumT-1), mThreadPool(NULL),
+	mPrecisionTolerance(1e-3), mNumPrecisionWarnings(0), mNumNearTies(0) {
+}
+
+Trellis::~Trellis() {
+	delete mThreadPool;
+	DeleteNodes();
+}
+
+// Every arc in the trellis is a forward arc of exactly one node. The arc lists are emptied before
+// the arcs are deleted, so that the arcs do not have to be removed from the lists one
+// at a time. Mitosis events that are not in the trellis are deleted by their Detections, which
+// only read the arena memory of the mitoses that are in the trellis.
+void Trellis::DeleteNodes(bool aArenasReleased) {
 	for (int t=0; t<mNumT; t++) {
-		mNodes.push_back(new vector<Node*>());
+		for (int h=0; h<(int)mHubs[t].size(); h++) {
+			if (mHubs[t][h] != NULL) {
+				mHubs[t][h]->mTrellis = NULL;
+				delete mHubs[t][h];
+			}
+		}
+		mHubs[t].clear();
+		mNumHubHoles[t] = 0;
 	}
+
+	vector<Arc*> arcs;
+	for (int i=0; i<(int)mNodes.size(); i++) {
+		for (int j=0; j<mNodes[i]->GetNumForwardArcs(); j++) {
+			arcs.push_back(mNodes[i]->GetForwardArc(j));
+		}
+	}
+	for (int i=0; i<(int)mNodes.size(); i++) {
+		mNodes[i]->ClearArcs();
+	}
+	for (int i=0; i<(int)arcs.size(); i++) {
+		if (aArenasReleased && Arena::IsInArena(arcs[i]) && !arcs[i]->OwnsHeapMemory()) {
+			continue;
+		}
+		delete arcs[i];
+	}
+	for (int i=0; i<(int)mNodes.size(); i++) {
+		delete mNodes[i];
+	}
+	mNodes.clear();
+	mLayerOffsets.assign(mNumT+1, 0);
 }
 
-Trellis::~Trellis() {
-	for (int t=0; t<(int)mNodes.size(); t++) {
-		for (int i=0; i<(int)mNodes[t]->size() ;i++) {
-			delete mNodes[t]->at(i);
+// Nodes are normally added one layer at a time, and then they are inserted at the end of mNodes.
+// All layer offsets after aT change, so adding the nodes one by one would cost O(T) per node.
+void Trellis::AddNodes(int aT, const vector<Node*> &aNodes) {
+	int numNodes = (int) aNodes.size();
+	if (numNodes == 0) {
+		return;
+	}
+	mNodes.insert(mNodes.begin() + mLayerOffsets[aT+1], aNodes.begin(), aNodes.end());
+	mNodeChanged.insert(mNodeChanged.begin() + mLayerOffsets[aT+1], numNodes, 0);
+	for (int t=aT+1; t<mNumT+1; t++) {
+		mLayerOffsets[t] += numNodes;
+	}
+	for (int i=0; i<numNodes; i++) {
+		aNodes[i]->SetTrellis(this, aT);
+	}
+
+	// The tables have the wrong size and have to be recreated.
+	mBestArcs.clear();
+	mBestScores.clear();
+	mPrevIndex.clear();
+	SetArcsChanged(aT);
+	if (aT+1 < mNumT) {
+		SetArcsChanged(aT+1);  // The arcs from the node are in the next layer.
+	}
+}
+
+void Trellis::BuildLayer(int aT) {
+	vector<int> &offsets = mArcOffsets[aT];
+	vector<int> &starts = mArcStarts[aT];
+	vector<Arc*> &arcs = mArcs[aT];
+
+	vector<char> &local = mArcLocal[aT];
+
+	offsets.resize(GetNumNodes(aT)+1);
+	starts.clear();
+	arcs.clear();
+	local.clear();
+	offsets[0] = 0;
+	for (int n=0; n<GetNumNodes(aT); n++) {
+		Node *node = GetNode(aT, n);
+		for (int i=0; i<node->GetNumBackwardArcs(); i++) {
+			Arc *bArc = node->GetBackwardArc(i);
+			starts.push_back(bArc->GetStartNode()->GetIndex());
+			arcs.push_back(bArc);
+			local.push_back(bArc->HasLocalScore());
+		}
+		offsets[n+1] = (int) arcs.size();
+	}
+	mArcScores[aT].resize(arcs.size());
+	mArcsChanged[aT] = false;
+}
+
+void Trellis::ForEachChunk(int aT, const function<void(int, int)> &aFunction) {
+	// The number of arcs that a thread should process at a time. Smaller layers are processed serially.
+	const int arcsPerChunk = 4096;
+
+	int numNodes = GetNumNodes(aT);
+	int numArcs = (int) mArcs[aT].size();
+	if (mThreadPool == NULL || numArcs <= arcsPerChunk) {
+		aFunction(0, numNodes);
+	} else {
+		// Chunks with roughly the same number of arcs.
+		int chunk = max((int) ((long long) numNodes * arcsPerChunk / numArcs), 1);
+		mThreadPool->ParallelFor(numNodes, chunk, aFunction);
+	}
+}
+
+void Trellis::ScoreLayer(int aT, bool aRescore) {
+	bool all = aRescore;
+	if (mArcsChanged[aT]) {
+		BuildLayer(aT);
+		all = true;
+	}
+	if (!all && !mScoresChanged[aT]) {
+		return;
+	}
+	mScoresChanged[aT] = false;
+	ForEachChunk(aT, [&](int aBegin, int aEnd) {
+		ScoreNodes(aT, aBegin, aEnd, all);
+	});
+}
+
+// GetScore only reads the state of the tracking problem, so this can be called for different
+// nodes in parallel.
+void Trellis::ScoreNodes(int aT, int aBegin, int aEnd, bool aAll) {
+	const int *offsets = &mArcOffsets[aT][0];
+	Arc *const *arcs = mArcs[aT].empty() ? NULL : &mArcs[aT][0];
+	const char *local = mArcLocal[aT].empty() ? NULL : &mArcLocal[aT][0];
+	TableScore *scores = mArcScores[aT].empty() ? NULL : &mArcScores[aT][0];
+	char *nodeChanged = mNodeChanged.data() + mLayerOffsets[aT];
+
+	for (int n=aBegin; n<aEnd; n++) {
+		bool changed = aAll || nodeChanged[n];
+		for (int i=offsets[n]; i<offsets[n+1]; i++) {
+			if (changed || !local[i]) {
+				scores[i] = arcs[i]->GetScore();
+			}
 		}
-		delete mNodes[t];
+		nodeChanged[n] = 0;
 	}
 }
 
-void Trellis::AddNode(int aT, Node *aNode) {
-	mNodes[aT]->push_back(aNode);
+// The hub list is compacted when more than half of it is holes, so that it does not grow when hubs
+// are added and removed repeatedly. The order of the hubs is kept, as it decides how ties are broken.
+void Trellis::AddHub(int aT, Hub *aHub) {
+	vector<Hub*> &hubs = mHubs[aT];
+	if (2*mNumHubHoles[aT] > (int)hubs.size()) {
+		int n = 0;
+		for (int h=0; h<(int)hubs.size(); h++) {
+			if (hubs[h] != NULL) {
+				hubs[h]->mPosition = n;
+				hubs[n] = hubs[h];
+				n++;
+			}
+		}
+		hubs.resize(n);
+		mNumHubHoles[aT] = 0;
+	}
+	aHub->mTrellis = this;
+	aHub->mLayer = aT;
+	aHub->mPosition = (int) hubs.size();
+	hubs.push_back(aHub);
+	SetLayerChanged(aT);
 }
 
-Node *Trellis::GetNode(int aT, int aN) {
-	return mNodes[aT]->at(aN);
+void Trellis::RemoveHub(Hub *aHub) {
+	mHubs[aHub->mLayer][aHub->mPosition] = NULL;
+	mNumHubHoles[aHub->mLayer]++;
+	SetLayerChanged(aHub->mLayer);
+	aHub->mTrellis = NULL;
+}
+
+void Trellis::SetArcsChanged(int aT) {
+	mArcsChanged[aT] = true;
+	SetLayerChanged(aT);
+}
+
+void Trellis::SetChanged(int aT, int aN) {
+	mNodeChanged[mLayerOffsets[aT]+aN] = 1;
+	mScoresChanged[aT] = true;
+	SetLayerChanged(aT);
+}
+
+void Trellis::SetLayerChanged(int aT) {
+	if (aT < mChangedLayer) {
+		mChangedLayer = aT;
+	}
+	if (aT > mLastChangedLayer) {
+		mLastChangedLayer = aT;
+	}
+}
+
+void Trellis::SetNumThreads(int aNumThreads) {
+	delete mThreadPool;
+	mThreadPool = NULL;
+	if (aNumThreads != 1) {
+		mThreadPool = new ThreadPool(aNumThreads);
+	}
+}
+
+// The tables are recreated, so that a switch between the modes does not use tables
+// that were not kept up to date in the previous mode.
+void Trellis::SetWindowed(bool aWindowed) {
+	mWindowed = aWindowed;
+	mBestArcs.clear();
+	mBestScores.clear();
+	mPrevIndex.clear();
+}
+
+void Trellis::CreateBackwardTables() {
+	mNextArcs.assign(mNodes.size(), NULL);
+	mScoresToGo.assign(mNodes.size(), -numeric_limits<TableScore>::max());
+	mNextIndex.assign(mNodes.size(), -1);
+	mBackwardValid = mNumT-1;
+
+	// All nodes in the last layer are end points.
+	for (int i=mLayerOffsets[mNumT-1]; i<mLayerOffsets[mNumT]; i++) {
+		mScoresToGo[i] = 0;
+	}
+}
+
+void Trellis::CreateTables(vector<Arc*> &aBestArcs, vector<TableScore> &aBestScores, vector<int> &aPrevIndex) {
+	aBestArcs.assign(mNodes.size(), NULL);
+	// Set all the best scores to minus infinity to handle states with in-degree 0.
+	aBestScores.assign(mNodes.size(), -numeric_limits<TableScore>::max());
+	aPrevIndex.assign(mNodes.size(), -1);  // -1 indicates that the node can not be reached.
+
+	// Set the initial scores to 0.
+	for (int n=0; n<GetNumNodes(0); n++) {
+		aBestScores[n] = 0;
+	}
 }
 
 // Finds the highest scoring path from the beginning of the trellis to the end using the Viterbi algorithm. For the
@@ -37,62 +265,460 @@ Node *Trellis::GetNode(int aT, int aN) {
 // higher indices. In the future this fuction could be replanced by a more general shortest-path algorithm.
 void Trellis::HighestScoringPath(list<Arc*> &aArcs, double &aScore) {
 
-	vector<vector<Arc*>*> bestArcs;		// The best arcs leading to the nodes.
-	vector<vector<double>*> bestScores;	// The highest possible score of going from the beginning of the trellis to a node.
-	vector<vector<int>*> prevIndex;		// Index of the previous node on the best path.
+	if (mBestArcs.size() != mNodes.size()) {
+		CreateTables(mBestArcs, mBestScores, mPrevIndex);
+		mChangedLayer = 1;
+		mLastChangedLayer = mNumT-1;
+		mForwardValid = 1;
+		mBackwardValid = mNumT-1;
+		mScoresToGo.clear();
+	}
+
+	if (mIncremental && mWindowed) {
+		WindowedPath(aArcs, aScore);
+		return;
+	}
 
-	for (int t=0; t<mNumT; t++) {
-		bestArcs.push_back(new vector<Arc*>(mNodes[t]->size(), NULL));
-		// Set all the best scores to minus infinity to handle states with in-degree 0.
-		bestScores.push_back(new vector<double>(mNodes[t]->size(), -numeric_limits<double>::max()));
-		prevIndex.push_back(new vector<int>(mNodes[t]->size(), -1));  // -1 indicates that the node can not be reached.
+	// Layers before mChangedLayer have the same scores as in the previous call.
+	mForwardValid = mIncremental ? min(mForwardValid, max(mChangedLayer, 1)) : 1;
+	mBackwardValid = mIncremental ? max(mBackwardValid, mLastChangedLayer) : mNumT-1;
+	Sweep(mForwardValid, mNumT-1, !mIncremental, mBestArcs, mBestScores, mPrevIndex);
+
+	if (mIncremental && mVerify && !VerifyTables()) {
+		lout << "Warning: The incremental Viterbi tables differed from a full recomputation." << endl;
 	}
+	mChangedLayer = mNumT;  // Nothing has changed since the tables were computed.
+	mLastChangedLayer = 0;
+	mForwardValid = mNumT;
 
-	// Set the initial scores to 0.
-    for (int n=0; n< (int) mNodes[0]->size(); n++) {
-        bestScores[0]->at(n) = 0;
-    }
-    
-	// Go through the layers one by one to find the highest scoring path from the beginning of the Trellis to the end.
-    for (int t=1; t<mNumT; t++) {
-        for (int n=0; n<(int)mNodes[t]->size(); n++) {
-            Node *node = mNodes[t]->at(n);
-			for (int i=0; i<node->GetNumBackwardArcs(); i++) {
-				Arc *bArc = node->GetBackwardArc(i);
-                int pIndex = bArc->GetStartNode()->GetIndex();
-                double score = bestScores[t-1]->at(pIndex) + bArc->GetScore();
-                if (i==0 || score > bestScores[t]->at(n)){
-                    bestArcs[t]->at(n) = bArc;
-                    bestScores[t]->at(n) = score;
-                    prevIndex[t]->at(n) = pIndex;
-                }
-            }
-        }
-    }
-    
-    // Backtrack to find the optimal path.
+	// Backtrack to find the optimal path.
 
 	// Find the highest scoring end state.
+	int endOffset = mLayerOffsets[mNumT-1];
 	int endIndex = 0;
-	for (int n=0; n<(int)mNodes[mNumT-1]->size(); n++){
-		if (bestScores[mNumT-1]->at(n) > bestScores[mNumT-1]->at(endIndex)) {
+	for (int n=0; n<GetNumNodes(mNumT-1); n++){
+		if (mBestScores[endOffset+n] > mBestScores[endOffset+endIndex]) {
 			endIndex = n;
 		}
 	}
 
 	int maxIndex = endIndex;
-    for (int t=mNumT-1; t>0; t--) {
-		aArcs.push_front(bestArcs[t]->at(maxIndex));
-        maxIndex = prevIndex[t]->at(maxIndex);
-    }
+	for (int t=mNumT-1; t>0; t--) {
+		int prevIndex = mPrevIndex[mLayerOffsets[t]+maxIndex];
+		aArcs.push_front(GetPathArc(mBestArcs[mLayerOffsets[t]+maxIndex], t, prevIndex, maxIndex));
+		maxIndex = prevIndex;
+	}
 
 	// Set output score.
-    aScore = bestScores[mNumT-1]->at(endIndex);
+	aScore = mBestScores[endOffset+endIndex];
+#ifdef SINGLE_PRECISION_SCORES
+	aScore = CheckPrecision(aArcs, aScore);
+	int numTies = CountNearTies(mNumT-1, endIndex);
+	if (numTies > 0) {
+		mNumNearTies += numTies;
+		lout << "Warning: " << numTies << " nodes on the best path had other paths within the single "
+			<< "precision rounding error." << endl;
+	}
+#endif
+}
+
+// Goes through the layers one by one to find the highest scoring path from the beginning of the Trellis
+// to the end. In each layer, the scores of the paths through all arcs are first computed from the
+// cached arc scores, and then the best arc into each node is selected. Both steps are linear passes
+// over the compact arc arrays. Large layers are split into chunks of nodes with roughly the same
+// number of arcs, which are processed by the threads in mThreadPool.
+void Trellis::Sweep(int aStartT, int aEndT, bool aRescore, vector<Arc*> &aBestArcs, vector<TableScore> &aBestScores,
+	vector<int> &aPrevIndex) {
+
+	for (int t=aStartT; t<=aEndT; t++) {
+		ScoreLayer(t, aRescore);
 
-	// Delete temporary vectors.
+		int numArcs = (int) mArcs[t].size();
+		if ((int) mPathScores.size() < numArcs) {
+			mPathScores.resize(numArcs);
+		}
+
+		ForEachChunk(t, [&](int aBegin, int aEnd) {
+			RelaxNodes(t, aBegin, aEnd, aBestArcs, aBestScores, aPrevIndex);
+		});
+		RelaxHubs(t, aBestArcs, aBestScores, aPrevIndex);
+	}
+}
+
+// Each node only reads the tables of the previous layer and writes its own elements of the tables
+// and of mPathScores, so different nodes can be processed in parallel.
+void Trellis::RelaxNodes(int aT, int aBegin, int aEnd, vector<Arc*> &aBestArcs, vector<TableScore> &aBestScores,
+	vector<int> &aPrevIndex) {
+
+	int numArcs = (int) mArcs[aT].size();
+	const int *offsets = &mArcOffsets[aT][0];
+	const int *starts = numArcs == 0 ? NULL : &mArcStarts[aT][0];
+	const TableScore *arcScores = numArcs == 0 ? NULL : &mArcScores[aT][0];
+	Arc *const *arcs = numArcs == 0 ? NULL : &mArcs[aT][0];
+	TableScore *pathScores = numArcs == 0 ? NULL : &mPathScores[0];
+	const TableScore *prevScores = &aBestScores[mLayerOffsets[aT-1]];
+	TableScore *scores = &aBestScores[mLayerOffsets[aT]];
+	Arc **bestArcs = &aBestArcs[mLayerOffsets[aT]];
+	int *prevIndex = &aPrevIndex[mLayerOffsets[aT]];
+
+	for (int i=offsets[aBegin]; i<offsets[aEnd]; i++) {
+		pathScores[i] = prevScores[starts[i]] + arcScores[i];
+	}
+
+	for (int n=aBegin; n<aEnd; n++) {
+		int begin = offsets[n];
+		int end = offsets[n+1];
+		if (begin == end) {
+			// The node can not be reached, but it may have been reachable in a previous sweep.
+			bestArcs[n] = NULL;
+			scores[n] = -numeric_limits<TableScore>::max();
+			prevIndex[n] = -1;
+			continue;
+		}
+		int bestI = begin;
+		for (int i=begin+1; i<end; i++) {
+			if (pathScores[i] > pathScores[bestI]) {
+				bestI = i;
+			}
+		}
+		bestArcs[n] = arcs[bestI];
+		scores[n] = pathScores[bestI];
+		prevIndex[n] = starts[bestI];
+	}
+}
+
+// The hubs are processed after the arcs, and a path through a hub only replaces the best arc into a
+// node if it has a higher score. The best entry of a hub does not depend on the exit, so it is only
+// searched for once.
+void Trellis::RelaxHubs(int aT, vector<Arc*> &aBestArcs, vector<TableScore> &aBestScores, vector<int> &aPrevIndex) {
+	const TableScore *prevScores = &aBestScores[mLayerOffsets[aT-1]];
+	TableScore *scores = &aBestScores[mLayerOffsets[aT]];
+	Arc **bestArcs = &aBestArcs[mLayerOffsets[aT]];
+	int *prevIndex = &aPrevIndex[mLayerOffsets[aT]];
+
+	for (int h=0; h<(int)mHubs[aT].size(); h++) {
+		Hub *hub = mHubs[aT][h];
+		if (hub == NULL || hub->GetNumEntries() == 0) {
+			continue;
+		}
+
+		int bestEntry = 0;
+		TableScore bestEntryScore = prevScores[hub->GetEntryNode(0)->GetIndex()] + hub->GetEntryScore(0);
+		for (int i=1; i<hub->GetNumEntries(); i++) {
+			TableScore score = prevScores[hub->GetEntryNode(i)->GetIndex()] + hub->GetEntryScore(i);
+			if (score > bestEntryScore) {
+				bestEntry = i;
+				bestEntryScore = score;
+			}
+		}
+		TableScore hubScore = bestEntryScore + hub->GetScore();
+		int entryIndex = hub->GetEntryNode(bestEntry)->GetIndex();
+
+		for (int j=0; j<hub->GetNumExits(); j++) {
+			TableScore score = hubScore + hub->GetExitScore(j);
+			int n = hub->GetExitNode(j)->GetIndex();
+			if (score > scores[n]) {
+				bestArcs[n] = hub;
+				scores[n] = score;
+				prevIndex[n] = entryIndex;
+			}
+		}
+	}
+}
+
+Arc *Trellis::GetPathArc(Arc *aArc, int aT, int aStartIndex, int aEndIndex) {
+	Hub *hub = dynamic_cast<Hub*>(aArc);
+	if (hub == NULL) {
+		return aArc;
+	}
+	return hub->GetArc(GetNode(aT-1, aStartIndex), GetNode(aT, aEndIndex));
+}
+
+bool Trellis::VerifyTables() {
+	vector<Arc*> bestArcs;
+	vector<TableScore> bestScores;
+	vector<int> prevIndex;
+	CreateTables(bestArcs, bestScores, prevIndex);
+	Sweep(1, mNumT-1, true, bestArcs, bestScores, prevIndex);
+
+	bool equal = true;
 	for (int t=0; t<mNumT; t++) {
-		delete bestArcs[t];
-		delete bestScores[t];
-		delete prevIndex[t];
+		for (int i=mLayerOffsets[t]; i<mLayerOffsets[t+1]; i++) {
+			if (bestArcs[i] != mBestArcs[i] || bestScores[i] != mBestScores[i] || prevIndex[i] != mPrevIndex[i]) {
+				lout << "The Viterbi tables differ in layer " << t << "." << endl;
+				equal = false;
+				break;
+			}
+		}
+	}
+
+	if (!equal) {
+		mBestArcs.swap(bestArcs);
+		mBestScores.swap(bestScores);
+		mPrevIndex.swap(prevIndex);
+	}
+	return equal;
+}
+
+// The backward arcs of layer t+1 are the forward arcs of layer t, so the compact representation of
+// layer t+1 is used to compute the tables of layer t. The arcs are visited in the order of their end
+// nodes, and therefore the node loop can not be split between threads without changing the order in
+// which ties are broken. Only the scoring is done in parallel.
+void Trellis::BackwardSweep(int aStartT, int aEndT) {
+	for (int t=aStartT; t>=aEndT; t--) {
+		ScoreLayer(t+1, false);
+
+		int numArcs = (int) mArcs[t+1].size();
+		const int *offsets = &mArcOffsets[t+1][0];
+		const int *starts = numArcs == 0 ? NULL : &mArcStarts[t+1][0];
+		const TableScore *arcScores = numArcs == 0 ? NULL : &mArcScores[t+1][0];
+		Arc *const *arcs = numArcs == 0 ? NULL : &mArcs[t+1][0];
+		const TableScore *nextScores = &mScoresToGo[mLayerOffsets[t+1]];
+		TableScore *scores = &mScoresToGo[mLayerOffsets[t]];
+		Arc **nextArcs = &mNextArcs[mLayerOffsets[t]];
+		int *nextIndex = &mNextIndex[mLayerOffsets[t]];
+
+		// Nodes without forward arcs can not reach the end of the trellis.
+		for (int n=0; n<GetNumNodes(t); n++) {
+			nextArcs[n] = NULL;
+			scores[n] = -numeric_limits<TableScore>::max();
+			nextIndex[n] = -1;
+		}
+
+		for (int n=0; n<GetNumNodes(t+1); n++) {
+			for (int i=offsets[n]; i<offsets[n+1]; i++) {
+				TableScore score = arcScores[i] + nextScores[n];
+				if (score > scores[starts[i]]) {
+					nextArcs[starts[i]] = arcs[i];
+					scores[starts[i]] = score;
+					nextIndex[starts[i]] = n;
+				}
+			}
+		}
+
+		// Hubs, where the best exit does not depend on the entry.
+		for (int h=0; h<(int)mHubs[t+1].size(); h++) {
+			Hub *hub = mHubs[t+1][h];
+			if (hub == NULL || hub->GetNumExits() == 0) {
+				continue;
+			}
+
+			int bestExit = 0;
+			TableScore bestExitScore = hub->GetExitScore(0) + nextScores[hub->GetExitNode(0)->GetIndex()];
+			for (int j=1; j<hub->GetNumExits(); j++) {
+				TableScore score = hub->GetExitScore(j) + nextScores[hub->GetExitNode(j)->GetIndex()];
+				if (score > bestExitScore) {
+					bestExit = j;
+					bestExitScore = score;
+				}
+			}
+			TableScore hubScore = hub->GetScore() + bestExitScore;
+			int exitIndex = hub->GetExitNode(bestExit)->GetIndex();
+
+			for (int i=0; i<hub->GetNumEntries(); i++) {
+				TableScore score = hub->GetEntryScore(i) + hubScore;
+				int n = hub->GetEntryNode(i)->GetIndex();
+				if (score > scores[n]) {
+					nextArcs[n] = hub;
+					scores[n] = score;
+					nextIndex[n] = exitIndex;
+				}
+			}
+		}
+	}
+}
+
+// Arcs that have changed in layers aFirst to aLast invalidate the forward tables from layer aFirst and
+// the backward tables up to layer aLast-1. A split layer is chosen in the middle of the changed window,
+// and the forward tables are recomputed up to the split layer, while the backward tables are recomputed
+// down to it. The split layer is moved as little as possible from the middle of the window if the tables
+// of other layers are still invalid from previous calls.
+void Trellis::WindowedPath(list<Arc*> &aArcs, double &aScore) {
+	if (mScoresToGo.size() != mNodes.size()) {
+		CreateBackwardTables();
+	}
+
+	int firstChanged = max(mChangedLayer, 1);
+	int lastChanged = mLastChangedLayer;
+
+	mForwardValid = min(mForwardValid, firstChanged);
+	mBackwardValid = max(mBackwardValid, lastChanged);
+
+	int split = firstChanged <= lastChanged ? (firstChanged + lastChanged) / 2 : mForwardValid - 1;
+	split = max(split, min(mForwardValid - 1, mBackwardValid));
+	split = min(split, max(mForwardValid - 1, mBackwardValid));
+
+	Sweep(mForwardValid, split, false, mBestArcs, mBestScores, mPrevIndex);
+	BackwardSweep(mBackwardValid - 1, split);
+
+	mForwardValid = max(mForwardValid, split + 1);
+	mBackwardValid = min(mBackwardValid, split);
+	mChangedLayer = mNumT;  // Nothing has changed since the tables were computed.
+	mLastChangedLayer = 0;
+
+	// Find the node in the split layer that the best path goes through.
+	int offset = mLayerOffsets[split];
+	int bestIndex = 0;
+	for (int n=1; n<GetNumNodes(split); n++) {
+		if (mBestScores[offset+n] + mScoresToGo[offset+n] >
+			mBestScores[offset+bestIndex] + mScoresToGo[offset+bestIndex]) {
+			bestIndex = n;
+		}
+	}
+	aScore = mBestScores[offset+bestIndex] + mScoresToGo[offset+bestIndex];
+
+	PathThrough(split, bestIndex, aArcs);
+#ifdef SINGLE_PRECISION_SCORES
+	aScore = CheckPrecision(aArcs, aScore);
+	int numTies = CountNearTies(split, bestIndex);
+	if (numTies > 0) {
+		mNumNearTies += numTies;
+		lout << "Warning: " << numTies << " nodes on the best path had other paths within the single "
+			<< "precision rounding error." << endl;
+	}
+#endif
+
+	if (mVerify && !VerifyScore(aScore)) {
+		lout << "Warning: The windowed search did not find the highest scoring path." << endl;
+	}
+}
+
+bool Trellis::VerifyScore(double aScore) {
+	vector<Arc*> bestArcs;
+	vector<TableScore> bestScores;
+	vector<int> prevIndex;
+	CreateTables(bestArcs, bestScores, prevIndex);
+	Sweep(1, mNumT-1, true, bestArcs, bestScores, prevIndex);
+
+	TableScore score = -numeric_limits<TableScore>::max();
+	for (int i=mLayerOffsets[mNumT-1]; i<mLayerOffsets[mNumT]; i++) {
+		score = max(score, bestScores[i]);
+	}
+
+	// The scores are summed in different orders, so they can differ by rounding errors. The
+	// rounding errors grow with the number of layers if the tables are stored in single precision.
+	double tolerance = max(1e-9, mNumT * (double) numeric_limits<TableScore>::epsilon());
+	if (fabs(aScore - score) > tolerance * max(fabs((double) score), 1.0)) {
+		lout << "The windowed score " << aScore << " differs from the full score " << score << "." << endl;
+		return false;
+	}
+	return true;
+}
+
+// The arcs on the path are scored again, as the cached arc scores have been rounded. Arcs without
+// local scores are scored in the current state of the tracking, which is the state that the
+// tables were computed in.
+double Trellis::CheckPrecision(const list<Arc*> &aArcs, double aTableScore) {
+	double score = 0;
+	for (list<Arc*>::const_iterator it = aArcs.begin(); it != aArcs.end(); it++) {
+		score += (*it)->GetScore();
+	}
+
+	if (fabs(score - aTableScore) > mPrecisionTolerance) {
+		mNumPrecisionWarnings++;
+		lout << "Warning: The single precision score " << aTableScore << " of the best path differs from the "
+			<< "double precision score " << score << ". Paths with similar scores may have been mixed up." << endl;
+	}
+	return score;
+}
+
+// Updates the best and the second best score of the paths into a node with a path that has the score
+// aScore and comes from node aStart in the previous layer. Parallel arcs, such as a Migration and a
+// Swap that represents the same migration, give paths with the same start and the same score. They
+// are not counted as different paths, as they tie in double precision as well.
+static void AddCandidate(TableScore aScore, int aStart, TableScore &aBest, int &aBestStart, TableScore &aSecond) {
+	if (aStart == aBestStart && aScore == aBest) {
+		return;
+	}
+	if (aScore > aBest) {
+		aSecond = aBest;
+		aBest = aScore;
+		aBestStart = aStart;
+	} else if (aScore > aSecond) {
+		aSecond = aScore;
+	}
+}
+
+// The paths into a node are scored in the same way as in RelaxNodes and RelaxHubs, so that the
+// compared scores have the same rounding errors as the ones in the tables. Each addition in single
+// precision can add a relative error of one epsilon, and the path into layer t has t additions.
+int Trellis::CountNearTies(int aT, int aN) {
+	const TableScore unreachable = -numeric_limits<TableScore>::max();
+	int numTies = 0;
+	int index = aN;
+	for (int t=aT; t>0 && index != -1; t--) {
+		const TableScore *prevScores = &mBestScores[mLayerOffsets[t-1]];
+		TableScore best = unreachable;
+		TableScore second = unreachable;
+		int bestStart = -1;
+
+		const vector<int> &offsets = mArcOffsets[t];
+		for (int i=offsets[index]; i<offsets[index+1]; i++) {
+			if (prevScores[mArcStarts[t][i]] == unreachable) {
+				continue;
+			}
+			AddCandidate(prevScores[mArcStarts[t][i]] + mArcScores[t][i], mArcStarts[t][i], best, bestStart, second);
+		}
+
+		for (int h=0; h<(int)mHubs[t].size(); h++) {
+			Hub *hub = mHubs[t][h];
+			if (hub == NULL) {
+				continue;
+			}
+			for (int j=0; j<hub->GetNumExits(); j++) {
+				if (hub->GetExitNode(j)->GetIndex() != index) {
+					continue;
+				}
+				for (int i=0; i<hub->GetNumEntries(); i++) {
+					TableScore entryScore = prevScores[hub->GetEntryNode(i)->GetIndex()];
+					if (entryScore == unreachable) {
+						continue;
+					}
+					TableScore score = ((TableScore) (entryScore + hub->GetEntryScore(i)) + hub->GetScore())
+						+ hub->GetExitScore(j);
+					AddCandidate(score, hub->GetEntryNode(i)->GetIndex(), best, bestStart, second);
+				}
+			}
+		}
+
+		double roundingError = t * numeric_limits<TableScore>::epsilon() * max(fabs((double) best), 1.0);
+		if (second != unreachable && best - second <= roundingError) {
+			numTies++;
+		}
+		index = mPrevIndex[mLayerOffsets[t]+index];
+	}
+	return numTies;
+}
+
+// Layers that were not recomputed in windowed mode are recomputed here. There are no changes
+// since the last call to HighestScoringPath, so all tables are valid afterwards.
+void Trellis::CompleteTables() {
+	if (mScoresToGo.size() != mNodes.size()) {
+		CreateBackwardTables();
+	}
+	Sweep(mForwardValid, mNumT-1, false, mBestArcs, mBestScores, mPrevIndex);
+	BackwardSweep(mBackwardValid-1, 0);
+	mForwardValid = mNumT;
+	mBackwardValid = 0;
+}
+
+double Trellis::GetScoreThrough(int aT, int aN) {
+	return mBestScores[mLayerOffsets[aT]+aN] + mScoresToGo[mLayerOffsets[aT]+aN];
+}
+
+// Backtracks to the beginning of the trellis and follows the best arcs to the end. Hubs on the
+// path are replaced by the arcs that they represent.
+void Trellis::PathThrough(int aT, int aN, list<Arc*> &aArcs) {
+	int index = aN;
+	for (int t=aT; t>0; t--) {
+		int prevIndex = mPrevIndex[mLayerOffsets[t]+index];
+		aArcs.push_front(GetPathArc(mBestArcs[mLayerOffsets[t]+index], t, prevIndex, index));
+		index = prevIndex;
+	}
+	index = aN;
+	for (int t=aT; t<mNumT-1; t++) {
+		int nextIndex = mNextIndex[mLayerOffsets[t]+index];
+		aArcs.push_back(GetPathArc(mNextArcs[mLayerOffsets[t]+index], t+1, index, nextIndex));
+		index = nextIndex;
 	}
 }
@@ -1,14 +1,26 @@
 #ifndef TRELLIS
 #define TRELLIS
 
+#include <functional>
 #include <list>
 #include <vector>
 
 class Arc;
+class Hub;
 class Node;
+class ThreadPool;
 
 using namespace std;
 
+// The type of the scores in the Viterbi tables. If SINGLE_PRECISION_SCORES is defined at compile
+// time, the tables are stored in single precision, which halves the memory traffic of the sweeps.
+// The arc scores are still computed in double precision by the arcs.
+#ifdef SINGLE_PRECISION_SCORES
+typedef float TableScore;
+#else
+typedef double TableScore;
+#endif
+
 // A graph with trellis structure. The edges (arcs) are directed and the nodes are arranged in layers. It has
 // a function HighestScoringPath that uses the Viterbi algorithm to find the highest scoring path
 // from the beginning of the trellis to the end. It is assumed that the arcs go from one layer to a layer
@@ -18,6 +30,44 @@ using namespace std;
 // and not just the best insertion of a new cell. The Trellis keeps track of nodes, but not the arcs.
 // The nodes keep track of the arcs.
 //
+// The tables computed by the Viterbi algorithm are kept between calls to HighestScoringPath. In
+// incremental mode, which is the default, only the layers from the first layer where the arc scores
+// may have changed are recomputed. The scores of the arcs are also cached, layer by layer, and
+// GetScore is only called again for arcs whose scores may have changed. The nodes report such changes
+// through SetChanged, which is called when the Variables and States that the arc scores depend on are
+// incremented or decremented. Arcs that do not have local scores (see Arc::HasLocalScore) are rescored
+// whenever anything in their layer changes. Adding or removing arcs rebuilds the cache of the layer.
+//
+// In windowed mode, a second set of tables with the highest possible scores of going from the nodes to
+// the end of the trellis is kept as well. Changes in a window of layers only invalidate the forward
+// tables after the window and the backward tables before the window, so it is enough to recompute the
+// forward tables up to a split layer in the window and the backward tables down to the same layer.
+// The best path goes through the node in the split layer where the sum of the forward and the backward
+// score is the highest. When the changes are spread over the whole trellis, this costs as much as a
+// full sweep. The best path has the same score as in normal mode, but when there are multiple paths
+// with the same score, or when the summation order changes the last bits of the scores, a different
+// path may be returned. Therefore windowed mode has to be turned on explicitly.
+//
+// The layers have to be processed one after the other, but the nodes within a layer are independent.
+// If SetNumThreads has been called with more than one thread, large layers are split into chunks of
+// nodes that are scored and relaxed in parallel. Every node is processed in the same way as in the
+// serial version, so the computed paths are identical regardless of the number of threads.
+//
+// In addition to the arcs, the layers can have Hubs, which represent complete bipartite sets of arcs
+// between the previous layer and the layer itself. A hub with m entries and n exits costs O(m+n) per
+// sweep instead of O(m*n). The hubs are processed after the arcs of the layer, and when a path goes
+// through a hub, the hub is asked for an arc that represents that part of the path.
+//
+// When the tables are stored in single precision (see TableScore), the rounding errors can make the
+// search pick a path that is not the best one in double precision, when the scores of the paths are
+// close to each other. Two checks guard against this. The score of the returned path is recomputed in
+// double precision from the arcs on the path, and that score is returned instead of the table score.
+// If the two differ by more than the precision tolerance, a warning is printed and counted. Then the
+// paths into every node on the returned path are compared, and a near tie is counted when the second
+// best path into a node is closer to the best one than the rounding error of the tables. Near ties
+// are where double precision could have picked a different path. In windowed mode, only the nodes
+// before the split layer are checked, as the forward tables are not valid after it.
+//
 // Known issues:
 // There will be a runtime error if there is no path from the first layer to the last layer.
 class Trellis {
@@ -25,26 +75,219 @@ public:
 	// Creates an empty Trellis of length aNumT with no nodes or arcs.
 	Trellis(int aNumT);
 
-	// Deletes the nodes.
+	// Deletes the nodes, if DeleteNodes has not been called.
 	virtual ~Trellis();
 
 	// Adds a node to layer aT.
-	void AddNode(int aT, Node *aNode);
+	void AddNode(int aT, Node *aNode) { AddNodes(aT, vector<Node*>(1, aNode)); }
+
+	// Adds the nodes in aNodes to the end of layer aT. The layer offsets are updated once for all
+	// of the nodes, so whole layers should be added this way when a large Trellis is built.
+	void AddNodes(int aT, const vector<Node*> &aNodes);
+
+	// Adds a Hub with exits in layer aT and entries in layer aT-1. The Trellis deletes the hubs
+	// that are left when the nodes are deleted.
+	void AddHub(int aT, Hub *aHub);
+
+	// Removes aHub from the Trellis without deleting it. Called by the destructor of Hub.
+	void RemoveHub(Hub *aHub);
 
 	// Returns node aN in layer aT.
-	Node *GetNode(int aT, int aN);
+	Node *GetNode(int aT, int aN) { return mNodes[mLayerOffsets[aT] + aN]; }
 
 	// Returns the number of nodes in layer aT.
-	int GetNumNodes(int aT) { return (int)mNodes[aT]->size(); }
+	int GetNumNodes(int aT) { return mLayerOffsets[aT+1] - mLayerOffsets[aT]; }
 
 	// Finds the highest scoring path through the Trellis and writes the arcs on the path into aArcs and
 	// the score of the path into aScore.
 	void HighestScoringPath(list<Arc*> &aArcs, double &aScore);
 
+	// Specifies that arcs ending in layer aT have been added or removed, so that the compact
+	// representation of the layer has to be rebuilt before the next sweep.
+	void SetArcsChanged(int aT);
+
+	// Specifies that the scores of arcs ending in node aN of layer aT may have changed. The
+	// scores of arcs without local scores in the same layer may also have changed.
+	void SetChanged(int aT, int aN);
+
+	// Sets the number of threads used to process the layers. The default is 1, which means that
+	// no extra threads are started. A value smaller than 1 uses one thread per core.
+	void SetNumThreads(int aNumThreads);
+
+	// Turns windowed search on or off. Windowed search only has an effect in incremental mode.
+	void SetWindowed(bool aWindowed);
+
+	// Turns incremental recomputation of the Viterbi tables on or off. If it is turned
+	// off, all layers are recomputed in every call to HighestScoringPath.
+	void SetIncremental(bool aIncremental) { mIncremental = aIncremental; }
+
+	// If aVerify is true, the incrementally computed Viterbi tables are compared to a full
+	// recomputation in every call to HighestScoringPath. Differences are printed and the
+	// result of the full recomputation is used. This is only meant for debugging.
+	void SetVerify(bool aVerify) { mVerify = aVerify; }
+
+	// Sets the largest allowed difference between the score of a path in the single precision
+	// tables and its score in double precision, before a warning is printed. The default is 1e-3.
+	// The check is only done if the tables are stored in single precision.
+	void SetPrecisionTolerance(double aTolerance) { mPrecisionTolerance = aTolerance; }
+
+	// Returns the number of paths where the single precision score differed from the double precision
+	// score by more than the precision tolerance. This is always 0 with double precision tables.
+	int GetNumPrecisionWarnings() const { return mNumPrecisionWarnings; }
+
+	// Returns the number of nodes on returned paths, where the second best path into the node was
+	// closer to the best path than the rounding error of the single precision tables. This is always
+	// 0 with double precision tables.
+	int GetNumNearTies() const { return mNumNearTies; }
+
 protected:
 	int mNumT;  // The number of layers in the trellis.
 
+	// Returns the hubs with exits in layer aT. Removed hubs leave NULL elements in the vector.
+	const vector<Hub*> &GetHubs(int aT) const { return mHubs[aT]; }
+
+	// Returns the threads that process the layers, or NULL if there is only one thread. Sub-classes
+	// can use the threads for other work between the calls to HighestScoringPath.
+	ThreadPool *GetThreadPool() { return mThreadPool; }
+
+	// Deletes all nodes and arcs. Sub-classes that allocate nodes or arcs from an Arena call this
+	// in their destructors, so that the objects are deleted before the Arena. If aArenasReleased is
+	// true, the caller destroys the arenas right after the call, and then arena arcs that do not own
+	// heap memory are left for the arenas to release instead of being deleted one by one.
+	void DeleteNodes(bool aArenasReleased = false);
+
+	// Computes the forward and the backward tables for all layers, so that the highest scoring path
+	// through any node can be found. This has to be called after HighestScoringPath, before any
+	// arcs or scores are changed.
+	void CompleteTables();
+
+	// Returns the score of the highest scoring path through node aN in layer aT. CompleteTables must
+	// have been called first.
+	double GetScoreThrough(int aT, int aN);
+
+	// Writes the arcs on the highest scoring path through node aN in layer aT into aArcs. CompleteTables
+	// must have been called first.
+	void PathThrough(int aT, int aN, list<Arc*> &aArcs);
+
 private:
-	vector<vector<Node*>*> mNodes;  // Element t contains the nodes in layer t.
+	// The nodes of all layers stored one layer after the other. The nodes in layer t are
+	// mNodes[mLayerOffsets[t]] to mNodes[mLayerOffsets[t+1]-1].
+	vector<Node*> mNodes;
+	vector<int> mLayerOffsets;
+
+	// Compact (CSR) representation of the backward arcs of the nodes in each layer. The
+	// backward arcs of node n in layer t are element mArcOffsets[t][n] to mArcOffsets[t][n+1]-1
+	// in mArcs[t] and the indices of their start nodes in layer t-1 are stored in mArcStarts[t].
+	// A layer is rebuilt from the nodes when mArcsChanged is true for it.
+	vector<vector<int> > mArcOffsets;
+	vector<vector<int> > mArcStarts;
+	vector<vector<Arc*> > mArcs;
+	vector<bool> mArcsChanged;
+
+	// Cached arc scores, indexed in the same way as mArcs, and flags that are true for arcs with
+	// local scores. A score is recomputed when mScoresChanged is true for its layer, and either
+	// the arc does not have a local score or mNodeChanged is true for its end node.
+	vector<vector<TableScore> > mArcScores;
+	vector<vector<char> > mArcLocal;
+	vector<bool> mScoresChanged;
+	vector<char> mNodeChanged;  // Not vector<bool>, as the elements are written from multiple threads.
+
+	// The hubs of each layer, with NULL in the positions of removed hubs, and the number of such holes.
+	vector<vector<Hub*> > mHubs;
+	vector<int> mNumHubHoles;
+
+	// Buffer with the scores of the paths through each arc in the layer that is being processed.
+	vector<TableScore> mPathScores;
+
+	bool mIncremental;		// True if only changed layers are recomputed.
+	bool mVerify;			// True if incremental results are compared to full recomputations.
+	bool mWindowed;			// True if changed windows of layers are searched using forward and backward tables.
+	int mChangedLayer;		// The first layer with arcs that may have changed scores since the last sweep.
+	int mLastChangedLayer;	// The last layer with arcs that may have changed scores since the last sweep.
+	int mForwardValid;		// In windowed mode, the forward tables are valid for layers before this layer.
+	int mBackwardValid;		// In windowed mode, the backward tables are valid for this layer and later layers.
+	ThreadPool *mThreadPool;	// Threads that process the layers, or NULL if the layers are processed serially.
+	double mPrecisionTolerance;	// Allowed rounding error in the score of a path in single precision tables.
+	int mNumPrecisionWarnings;	// Number of paths where the rounding error exceeded mPrecisionTolerance.
+	int mNumNearTies;			// Number of nodes on paths where another path was within the rounding error.
+
+	// Viterbi tables with one element per node, indexed in the same way as mNodes.
+	vector<Arc*> mBestArcs;		// The best arcs leading to the nodes.
+	vector<TableScore> mBestScores;	// The highest possible score of going from the beginning of the trellis to a node.
+	vector<int> mPrevIndex;		// Index of the previous node on the best path, in the previous layer.
+
+	// Backward tables, used in windowed mode and by CompleteTables, with one element per node.
+	vector<Arc*> mNextArcs;			// The best arcs leaving the nodes.
+	vector<TableScore> mScoresToGo;		// The highest possible score of going from a node to the end of the trellis.
+	vector<int> mNextIndex;			// Index of the next node on the best path, in the next layer.
+
+	// Specifies that the paths into layer aT may have changed, so that the layer has to be swept again.
+	void SetLayerChanged(int aT);
+
+	// Rebuilds the compact representation of the backward arcs in layer aT. The arcs have to be
+	// scored afterwards.
+	void BuildLayer(int aT);
+
+	// Calls aFunction(begin, end) for chunks of nodes that together cover layer aT. The chunks are
+	// processed in parallel if the layer has enough arcs and there are multiple threads.
+	void ForEachChunk(int aT, const function<void(int, int)> &aFunction);
+
+	// Rebuilds layer aT if its arcs have changed and recomputes the arc scores that may have changed.
+	// If aRescore is true, all arc scores in the layer are recomputed.
+	void ScoreLayer(int aT, bool aRescore);
+
+	// Recomputes the cached scores of the arcs that may have changed, for the arcs ending in nodes
+	// aBegin to aEnd-1 of layer aT. If aAll is true, all of the scores are recomputed.
+	void ScoreNodes(int aT, int aBegin, int aEnd, bool aAll);
+
+	// Selects the best backward arcs of nodes aBegin to aEnd-1 in layer aT, given that the Viterbi
+	// tables of layer aT-1 have been computed.
+	void RelaxNodes(int aT, int aBegin, int aEnd, vector<Arc*> &aBestArcs, vector<TableScore> &aBestScores,
+		vector<int> &aPrevIndex);
+
+	// Updates the Viterbi tables of layer aT with the paths through the hubs of the layer, given that the
+	// arcs of the layer have been processed.
+	void RelaxHubs(int aT, vector<Arc*> &aBestArcs, vector<TableScore> &aBestScores, vector<int> &aPrevIndex);
+
+	// Returns the arc to put on a path for an element aArc of the Viterbi tables, which goes from node
+	// aStartIndex in layer aT-1 to node aEndIndex in layer aT. This is aArc itself unless it is a Hub.
+	Arc *GetPathArc(Arc *aArc, int aT, int aStartIndex, int aEndIndex);
+
+	// Gives Viterbi tables one element per node, and sets the scores of the first layer to 0.
+	void CreateTables(vector<Arc*> &aBestArcs, vector<TableScore> &aBestScores, vector<int> &aPrevIndex);
+
+	// Gives the backward tables one element per node, and sets the scores of the last layer to 0.
+	void CreateBackwardTables();
+
+	// Computes the Viterbi tables for the layers from aStartT to aEndT. If aRescore is true, the
+	// scores of all arcs are recomputed.
+	void Sweep(int aStartT, int aEndT, bool aRescore, vector<Arc*> &aBestArcs, vector<TableScore> &aBestScores,
+		vector<int> &aPrevIndex);
+
+	// Computes the backward tables for the layers from aStartT down to aEndT, given that the backward
+	// tables of layer aStartT+1 have been computed.
+	void BackwardSweep(int aStartT, int aEndT);
+
+	// Finds the highest scoring path using the forward and the backward tables, after updating the
+	// tables in the window of layers that has changed since the last call.
+	void WindowedPath(list<Arc*> &aArcs, double &aScore);
+
+	// Recomputes all layers and compares the result to the cached tables. Returns true if the
+	// tables are identical. Otherwise the cached tables are replaced by the recomputed ones.
+	bool VerifyTables();
+
+	// Compares the score of a path found in windowed mode to the score found by a full recomputation.
+	// Returns true if the scores are equal, up to rounding errors.
+	bool VerifyScore(double aScore);
+
+	// Recomputes the score of the path aArcs in double precision and compares it to the score aTableScore
+	// that was found in the Viterbi tables. A warning is printed if the difference exceeds the precision
+	// tolerance. Returns the double precision score.
+	double CheckPrecision(const list<Arc*> &aArcs, double aTableScore);
+
+	// Goes back from node aN in layer aT along the best path in the forward tables, and compares the
+	// best and the second best path into each node. Returns the number of nodes where the difference
+	// is smaller than the rounding error of the tables.
+	int CountNearTies(int aT, int aN);
 };
-#endif
\ No newline at end of file
+#endif
@@ -2,23 +2,36 @@
 #include <assert.h>
 #include <algorithm>
 #include <vector>
+#include "Arena.h"
 
 using namespace std;
 
 // Dummy constructor for events that don't have a real variable associated with them.
 Variable::Variable()
-	: mScore(2,0), mValue(0), mNumScores(2) {
+	: mValue(0), mNumScores(2), mScore(mInlineScores) {
+		mInlineScores[0] = 0.0;
+		mInlineScores[1] = 0.0;
 }
 
 Variable::Variable(int aValue, int aNumScores, const double *aScores)
-	: mScore(aNumScores, 0.0), mValue(aValue), mNumScores(aNumScores) {
-		
-		// Copy the scores to the vector.
+	: mValue(aValue), mNumScores(aNumScores), mScore(mInlineScores) {
+
+		if (aNumScores > INLINE_SCORES) {
+			mScore = (double *) Arena::Allocate(aNumScores * sizeof(double));
+		}
+
+		// Copy the scores.
 		for (int i=0; i<aNumScores; i++) {
 			mScore[i] = aScores[i];
 		}
 }
 
+Variable::~Variable() {
+	if (mScore != mInlineScores) {
+		Arena::Free(mScore, mNumScores * sizeof(double));
+	}
+}
+
 
 double Variable::GetMinusScore() const {
 	//// Old version where events were free when enough of them had been added.
@@ -1,7 +1,7 @@
 #ifndef VARIABLE
 #define VARIABLE
 
-#include <vector>
+#include <cstddef>  // To get size_t.
 
 using namespace std;
 
@@ -12,6 +12,12 @@ using namespace std;
 // aNumScores-1. The scores associated with increasing or decrasing the value of
 // the Variable are most interesting. All Event classes and the Count class inherits
 // from Variable.
+//
+// To keep the events small, up to INLINE_SCORES scores are stored in the object
+// itself, which covers all events that have scores. Longer score arrays, which
+// Count objects have, are allocated from the current Arena, so that the scores of
+// all Counts in a CellTrellis are stored together in the memory pool of the
+// trellis instead of in separate heap allocations.
 class Variable {
 	// CellNode and Detection are he only classes that are allowed to call the Plus and Minus functions.
 	friend class CellNode;
@@ -21,12 +27,16 @@ public:
 	// TODO: MAKE THIS NICER.
 	Variable();
 
-	virtual ~Variable() { ; }
+	// Frees the scores if they are not stored in the object.
+	virtual ~Variable();
 
 	// Creates a Variable with aNumScores predefined values found in aScores.
 	// The variable starts with the value aValue.
 	Variable(int aValue, int aNumScores, const double *aScores);
 
+	// Returns the number of bytes used to store the scores outside the object.
+	size_t GetNumScoreBytes() const { return (mNumScores > INLINE_SCORES) ? mNumScores * sizeof(double) : 0; }
+
 	// Returns the score associated with increasing the value by 1. If the value is already 
 	// mNumScores-1 or more, the score does not change if it is increased further.
 	virtual double GetPlusScore() const;
@@ -45,8 +55,16 @@ protected:
 	int GetValue() { return mValue; }
 
 private:
+	// The number of scores that are stored in the object.
+	static const int INLINE_SCORES = 2;
+
 	int mValue;				// Value of the Variable. Usually the number of times that an event occurs.
 	int mNumScores;			// The number of predefined scores.
-	vector<double> mScore;  // Vector with scores for the Variable being equal to 0, 1,... mNumScores-1.
+	double *mScore;			// Scores for the Variable being equal to 0, 1,... mNumScores-1.
+	double mInlineScores[INLINE_SCORES];  // Storage for mScore, if there are at most INLINE_SCORES scores.
+
+	// mScore can point into the object, so Variables can not be copied.
+	Variable(const Variable &) = delete;
+	Variable &operator=(const Variable &) = delete;
 };
 #endif
\ No newline at end of file
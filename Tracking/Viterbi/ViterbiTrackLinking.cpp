@@ -1,19 +1,123 @@
-// Create the precompiler definition MATLAB in to compile mex file. Otherwise a standalone executable for for debugging will be generated.
+// Create the precompiler definition MATLAB in to compile mex file. Otherwise a standalone executable, which reads the inputs from binary files, will be generated.
 
 #include "ArraySave.h"
-#include "CellTrellis.h"
 #include "LogStream.h"
-#include "Tree.h"
+#include "ScoreMatrix.h"
+#include "TrackLinker.h"
 
+#include <algorithm>
 #include <string>
-#include <sstream>
+#include <utility>
+#include <vector>
 
+#ifdef MATLAB
 // Matlab types and functions.
 #include "mex.h"
 #include "matrix.h"
+#else
+#include <cstdlib>
+#include <iostream>
+#endif
 
 using namespace std;
 
+#ifdef MATLAB
+
+// Creates a matrix with one row per iteration from the trace of aLinker.
+static mxArray *TraceMatrix(const TrackLinker &aLinker) {
+	int numRows = aLinker.GetNumTraceRows();
+	const vector<double> &trace = aLinker.GetTrace();
+	mxArray *traceMatrix = mxCreateDoubleMatrix(numRows, TrackLinker::NUM_TRACE_COLUMNS, mxREAL);
+	double *traceA = mxGetPr(traceMatrix);
+	for (int i=0; i<numRows; i++) {
+		for (int j=0; j<TrackLinker::NUM_TRACE_COLUMNS; j++) {
+			traceA[j*numRows+i] = trace[i*TrackLinker::NUM_TRACE_COLUMNS+j];
+		}
+	}
+	return traceMatrix;
+}
+
+// Returns the ScoreMatrix type of a column with the Matlab class aClass. Returns false if
+// the class can not be used.
+static bool ColumnType(mxClassID aClass, ScoreMatrix::Type *aType) {
+	switch (aClass) {
+	case mxDOUBLE_CLASS:
+		*aType = ScoreMatrix::DOUBLE;
+		return true;
+	case mxSINGLE_CLASS:
+		*aType = ScoreMatrix::SINGLE;
+		return true;
+	case mxINT32_CLASS:
+		*aType = ScoreMatrix::INT32;
+		return true;
+	default:
+		return false;
+	}
+}
+
+// Creates a ScoreMatrix which points to the data of the Matlab input aArray, without copying it.
+// aArray can be a double, single or int32 matrix, or a scalar struct where every field is a column
+// vector with one of these classes. The fields are taken as columns in the order they were
+// created. aNumCols is the required number of columns, or 0 if any number of columns is allowed.
+// aName is used in the error messages.
+static ScoreMatrix ToScoreMatrix(const mxArray *aArray, int aNumCols, string aName) {
+	ScoreMatrix::Type type;
+	if (mxIsStruct(aArray)) {
+		int numFields = mxGetNumberOfFields(aArray);
+		if (mxGetNumberOfElements(aArray) != 1 || numFields == 0) {
+			mexErrMsgTxt(("The " + aName + " struct must be a scalar struct with one field per column").c_str());
+		}
+		// Fields that have not been assigned are NULL.
+		const mxArray *firstColumn = mxGetFieldByNumber(aArray, 0, 0);
+		int numRows = (firstColumn == NULL) ? 0 : (int) mxGetNumberOfElements(firstColumn);
+		ScoreMatrix matrix(numRows);
+		for (int f=0; f<numFields; f++) {
+			const mxArray *column = mxGetFieldByNumber(aArray, 0, f);
+			if (column == NULL || !ColumnType(mxGetClassID(column), &type) || mxIsComplex(column)
+				|| (int) mxGetNumberOfElements(column) != numRows) {
+				mexErrMsgTxt(("The fields of the " + aName + " struct must be real double, single or int32 "
+					"vectors of the same length").c_str());
+			}
+			matrix.AddColumn(mxGetData(column), type);
+		}
+		if (aNumCols > 0 && matrix.GetNumCols() != aNumCols) {
+			mexErrMsgTxt(("The " + aName + " struct has the wrong number of fields").c_str());
+		}
+		return matrix;
+	}
+
+	if (!ColumnType(mxGetClassID(aArray), &type) || mxIsComplex(aArray)) {
+		mexErrMsgTxt(("The " + aName + " matrix must be a real double, single or int32 matrix, or a struct").c_str());
+	}
+	int numRows = (int) mxGetM(aArray);
+	int numCols = (int) mxGetN(aArray);
+	if (aNumCols > 0 && numRows > 0 && numCols != aNumCols) {
+		mexErrMsgTxt(("The " + aName + " matrix has the wrong number of columns").c_str());
+	}
+	size_t elementSize = mxGetElementSize(aArray);
+	ScoreMatrix matrix(numRows);
+	for (int j=0; j<numCols; j++) {
+		matrix.AddColumn((const char *) mxGetData(aArray) + j * numRows * elementSize, type);
+	}
+	return matrix;
+}
+
+// Copies the elements of the Matlab input aArray into aValues, converting them to double. aArray can
+// be a double, single or int32 array. aName is used in the error message.
+static void ToDoubles(const mxArray *aArray, string aName, vector<double> &aValues) {
+	ScoreMatrix::Type type;
+	if (!ColumnType(mxGetClassID(aArray), &type) || mxIsComplex(aArray)) {
+		mexErrMsgTxt(("The " + aName + " matrix must be a real double, single or int32 matrix").c_str());
+	}
+	int numElements = (int) mxGetNumberOfElements(aArray);
+	ScoreMatrix column(numElements);
+	column.AddColumn(mxGetData(aArray), type);
+	aValues.resize(numElements);
+	for (int i=0; i<numElements; i++) {
+		aValues[i] = column.Get(i, 0);
+	}
+}
+
 /* Function that interfaces with Matlab. "/" is used instead of "\" in path
 * names as "\" does not work on mac and linux. Windows does not care.
 *
@@ -26,154 +130,445 @@ using namespace std;
 * mxArray *prhs[4]	- Apoptosis events.
 * mxArray *prhs[5]	- Appearance events.
 * mxArray *prhs[6]	- Disappearnace events.
+*                     The event inputs prhs[1] to prhs[6] can be double, single
+*                     or int32 matrices, or scalar structs with one field per
+*                     column, where each field is a double, single or int32
+*                     vector. The columns are described in CellTrellis.h. Int32
+*                     index columns and single score columns use less memory
+*                     than double matrices, and the data are used without
+*                     being copied or converted.
 * mxArray *prhs[7]	- If this is != 0, there will be a single idle state in the
 *                     trellis instead of one for appearing and one for disappearing
 *                     cells. 
 * mxArray *prhs[8]	- Maximum score increase for a migration.
-* mxArray *prhs[9]	- Path where intermediate results can be saved as binary
-*                     files. It it left empty, no intermediate files are saved.   
+* mxArray *prhs[9]	- Path where intermediate results can be saved in the
+*                     binary log file iterations.bin. The log has the changes
+*                     of every iteration and is described in
+*                     TrackLinker::SetIterationPath. It it left empty, no
+*                     intermediate results are saved.
 * mxArray *prhs[10]	- Folder to save intermediate results to.
+* mxArray *prhs[11]	- (Optional) Number of threads used to find the highest
+*                     scoring paths. Values smaller than 1 use one thread per
+*                     core. The default is 1. The results do not depend on the
+*                     number of threads.
+* mxArray *prhs[12]	- (Optional) If this is != 0, only the window of frames
+*                     that changed in the previous iteration is searched, using
+*                     tables with scores both from the beginning and from the
+*                     end of the sequence. The default is 0.
+* mxArray *prhs[13]	- (Optional) The maximum number of cells that can be added
+*                     in each iteration. If this is larger than 1, cells with
+*                     disjoint detections are added together. The default is 1.
+* mxArray *prhs[14]	- (Optional) If this is != 0, the swaps of each cell are
+*                     represented by a hub that is evaluated during the search,
+*                     instead of by one arc per swap. The default is 0.
+* mxArray *prhs[15]	- (Optional) Detection numbers for all cells in a previous
+*                     tracking result, in the same format as plhs[0]. The cells
+*                     are added to the tree before the first iteration, so that
+*                     the tracking continues from the previous result. Cells
+*                     with events that are not in the trellis are left out. If
+*                     this is given, prhs[16] and prhs[17] must also be given.
+*                     The matrices of the previous result can be double, single
+*                     or int32 arrays. The default is to start from an empty
+*                     tree.
+* mxArray *prhs[16]	- (Optional) Mitosis relationships between the cells in
+*                     prhs[15], in the same format as plhs[1].
+* mxArray *prhs[17]	- (Optional) Deaths of the cells in prhs[15], in the same
+*                     format as plhs[2].
+* mxArray *prhs[18]	- (Optional) If this is larger than 0, the images are linked
+*                     online, one window of this many images at a time, using
+*                     an OnlineLinker. The default is 0, which means that all
+*                     images are linked together.
+* mxArray *prhs[19]	- (Optional) The number of images at the end of each
+*                     window that are kept in the window after it has been
+*                     linked in online linking. The first of them is frozen
+*                     when the next window is linked, so the tracks can only
+*                     change in the remaining images. Values smaller than 1
+*                     give half of the window size, which is also the default.
+* mxArray *prhs[20]	- (Optional) If this is != 0, the detections are split into
+*                     components that are not linked by any migrations or
+*                     mitoses, and the components are linked in parallel using
+*                     a ComponentLinker. The default is 0.
+* mxArray *prhs[21]	- (Optional) The score that a cell must add to the
+*                     tracking result to be added. The track linking stops
+*                     when no cell can be added with a higher score. The
+*                     default is 0, which means that cells are added as long
+*                     as they increase the score.
+* mxArray *prhs[22]	- (Optional) The maximum number of iterations. The default
+*                     is 0, which means that there is no limit. Can only be
+*                     used when all images are linked together.
+* mxArray *prhs[23]	- (Optional) Time budget in seconds for the iterations. No
+*                     new iteration is started after the budget has been used.
+*                     The default is 0, which means that there is no limit. Can
+*                     only be used when all images are linked together.
+* mxArray *prhs[24]	- (Optional) Verbosity of the printouts, from 0 (only
+*                     warnings) to 3 (every executed event). The levels are
+*                     defined in LogStream. The default is 3.
+* mxArray *prhs[25]	- (Optional) If this is != 0, the printouts are written
+*                     asynchronously by a background thread. Printouts to the
+*                     command window are then collected and printed in large
+*                     batches. The default is 0.
 *
 * Outputs:
 * int nlhs			- Number of outputs
 * mxArray *plhs[0]	- Detection numbers for all cells
 * mxArray *plhs[1]	- Mitosis relationships between cells.
+* mxArray *plhs[2]	- Binary vector indicating which cells die.
+* mxArray *plhs[3]	- (Optional) Trace with one row per iteration. The columns
+*                     are the iteration number, the number of added cells, the
+*                     added score, the time in seconds spent searching for the
+*                     highest scoring path, the time of the whole iteration,
+*                     the numbers of swaps that were created and deleted, and
+*                     the number of cells in the tree after the iteration. The
+*                     trace is empty in online linking and when the problem is
+*                     decomposed into components.
 */
 void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
 
 	// Check the number of input and output arguments
-	if (nrhs != 11) {
-		mexErrMsgTxt("Must have 11 input arguments");
+	if (nrhs < 11 || nrhs > 26) {
+		mexErrMsgTxt("Must have between 11 and 26 input arguments");
+	}
+	if (nrhs > 15 && nrhs < 18) {
+		mexErrMsgTxt("The cell, mitosis and death matrices of a previous result must be given together");
 	}
-	if (nlhs != 3) {
-		mexErrMsgTxt("Must have 2 output arguments");
+	if (nlhs < 3 || nlhs > 4) {
+		mexErrMsgTxt("Must have 3 or 4 output arguments");
+	}
+
+
+	// lout keeps its settings between calls to the mex-file.
+	lout.SetVerbosity(nrhs > 24 ? (int) *mxGetPr(prhs[24]) : LogStream::VERBOSITY_EVENTS);
+	if (lout.IsVerbose(LogStream::VERBOSITY_SUMMARY)) {
+		lout << "Running ViterbiTrackLinking from Matlab." << endl << endl;
 	}
-    
-    lout << "Running ViterbiTrackLinking from Matlab." << endl << endl; 
 
 	// Get inputs
-	double *numDetsA = mxGetPr(prhs[0]);
-	double *countA = mxGetPr(prhs[1]);
-	double *migA = mxGetPr(prhs[2]);
-	double *mitA = mxGetPr(prhs[3]);
-	double *apoA = mxGetPr(prhs[4]);
-	double *appearA = mxGetPr(prhs[5]);
-	double *disappearA = mxGetPr(prhs[6]);
+	int tMax = (int) mxGetNumberOfElements(prhs[0]);  // Allow numDetsA to be either row or column vector.
+	vector<double> numDetsA(max(tMax, 1));
+	ScoreMatrix::Type numDetsType;
+	if (!ColumnType(mxGetClassID(prhs[0]), &numDetsType)) {
+		mexErrMsgTxt("The detection counts must be a double, single or int32 array");
+	}
+	ScoreMatrix numDets(tMax);
+	numDets.AddColumn(mxGetData(prhs[0]), numDetsType);
+	for (int t=0; t<tMax; t++) {
+		numDetsA[t] = numDets.Get(t, 0);
+	}
+	ScoreMatrix count = ToScoreMatrix(prhs[1], 0, "count");
+	ScoreMatrix mig = ToScoreMatrix(prhs[2], 5, "migration");
+	ScoreMatrix mit = ToScoreMatrix(prhs[3], 6, "mitosis");
+	ScoreMatrix apo = ToScoreMatrix(prhs[4], 4, "apoptosis");
+	ScoreMatrix appear = ToScoreMatrix(prhs[5], 4, "appearance");
+	ScoreMatrix disappear = ToScoreMatrix(prhs[6], 4, "disappearance");
 	bool singleIdleState = (*mxGetPr(prhs[7]) != 0);
 	double maxMigScore = *mxGetPr(prhs[8]);
 	char iterationPath[1000];
 	mxGetString(prhs[9], iterationPath, 1000);
-    bool saveIterationFiles = mxGetNumberOfElements(prhs[9]) > 0;
 	char logFilePath[1000];
 	mxGetString(prhs[10], logFilePath, 1000);
     bool saveLogFile = mxGetNumberOfElements(prhs[10]) > 0;
 
+	int maxCount = count.GetNumCols()-3; // first element is t, second is detection index and the third is the debris probability
 
-	// Get the dimensions of the inputs.
-	const mwSize *countSize = mxGetDimensions(prhs[1]);
-	const mwSize *migSize = mxGetDimensions(prhs[2]);
-	const mwSize *mitSize = mxGetDimensions(prhs[3]);
-	const mwSize *apoSize = mxGetDimensions(prhs[4]);
-	const mwSize *appearSize = mxGetDimensions(prhs[5]);
-	const mwSize *disappearSize = mxGetDimensions(prhs[6]);
-	int tMax = (int) mxGetNumberOfElements(prhs[0]);  // Allow numDetsA to be either row or column vector.
-	int maxCount = countSize[1]-3; // first element is t, second is detection index and the third is the debris probability
-	int numMigs = migSize[0];
-	int numMits = mitSize[0];
-	int numApos = apoSize[0];
-	int numAppear = appearSize[0];
-	int numDisappear = disappearSize[0];
+	TrackLinker linker(singleIdleState, tMax, maxCount, &numDetsA[0], count, mig, mit, apo, appear, disappear,
+		maxMigScore);
+	if (mxGetNumberOfElements(prhs[9]) > 0) {
+		linker.SetIterationPath(iterationPath);
+	}
+	if (nrhs > 11) {
+		linker.SetNumThreads((int) *mxGetPr(prhs[11]));
+	}
+	if (nrhs > 12) {
+		linker.SetWindowed(*mxGetPr(prhs[12]) != 0);
+	}
+	if (nrhs > 13) {
+		linker.SetBatchSize((int) *mxGetPr(prhs[13]));
+	}
+	if (nrhs > 14) {
+		linker.SetLazySwaps(*mxGetPr(prhs[14]) != 0);
+	}
+	// The linker keeps pointers to the warm start matrices, which are converted to double.
+	vector<double> warmCellA;
+	vector<double> warmDivA;
+	vector<double> warmDeathA;
+	if (nrhs > 15 && mxGetNumberOfElements(prhs[15]) > 0) {
+		if ((int) mxGetM(prhs[15]) != tMax) {
+			mexErrMsgTxt("The cell matrix of the previous result must have one row per image");
+		}
+		if ((int) mxGetNumberOfElements(prhs[16]) != 2 * (int) mxGetN(prhs[15])
+			|| (int) mxGetNumberOfElements(prhs[17]) != (int) mxGetN(prhs[15])) {
+			mexErrMsgTxt("The mitosis and death matrices of the previous result must have one row per cell");
+		}
+		ToDoubles(prhs[15], "warm start cell", warmCellA);
+		ToDoubles(prhs[16], "warm start mitosis", warmDivA);
+		ToDoubles(prhs[17], "warm start death", warmDeathA);
+		linker.SetWarmStart((int) mxGetN(prhs[15]), &warmCellA[0], warmDivA.empty() ? NULL : &warmDivA[0],
+			warmDeathA.empty() ? NULL : &warmDeathA[0]);
+	}
+	if (nrhs > 18) {
+		linker.SetOnline((int) *mxGetPr(prhs[18]), nrhs > 19 ? (int) *mxGetPr(prhs[19]) : 0);
+	}
+	if (nrhs > 20) {
+		linker.SetDecompose(*mxGetPr(prhs[20]) != 0);
+	}
+	if (nrhs > 21) {
+		linker.SetMinScore(*mxGetPr(prhs[21]));
+	}
+	if (nrhs > 22) {
+		linker.SetMaxIterations((int) *mxGetPr(prhs[22]));
+	}
+	if (nrhs > 23) {
+		linker.SetTimeBudget(*mxGetPr(prhs[23]));
+	}
+
+	string settingsError = linker.CheckSettings();
+	if (!settingsError.empty()) {
+		mexErrMsgTxt(settingsError.c_str());
+	}
 
     if (saveLogFile) {
         lout.OpenFile(logFilePath);
     }
+	if (nrhs > 25) {
+		lout.SetAsync(*mxGetPr(prhs[25]) != 0);
+	}
+
+	linker.Link();
 
-	// Create a trellis graph that will be used to solve the tracknig problem.
-	CellTrellis cellTrellis(singleIdleState, tMax, maxCount, numMigs, numMits, numApos, numAppear, numDisappear,
-		numDetsA, countA, migA, mitA, apoA, appearA, disappearA, maxMigScore);
-    
-	// Add cells iteratively until as long as the score increases.
-	int iter = 1;
-	int addedCells = 0;
-	Tree *tree = cellTrellis.GetTree();
-
-	while (true) {
-		tree->SetIteration(iter);
-		lout << "Iteration " << iter << endl;
-		addedCells = cellTrellis.AddCell();
-        
-        // No modifications were made in the last iteration.
-        if (addedCells == 0) {
-            break;
-        }
-
-        if (saveIterationFiles) {
-            // Save tracking matrices after each iterations, so that the algorithm steps
-            // can be looked at later.
-            double *cellArray = new double[tMax*tree->GetNumCells()];
-            double *divArray = new double[tree->GetNumCells()*2];
-            double *deathArray = new double[tree->GetNumCells()];
-            tree->GetCells(cellArray, divArray, deathArray);
-            
-            // Detection indices.
-            int cellArrayDims[2];
-            cellArrayDims[0] = tMax;
-            cellArrayDims[1] = tree->GetNumCells();
-            stringstream cellArrayPath;
-            cellArrayPath << iterationPath << "/cellArray" << setw(5) << setfill('0') << iter << ".bin";
-            
-            // Cell divisions.
-            int divArrayDims[2];
-            divArrayDims[0] = tree->GetNumCells();
-            divArrayDims[1] = 2;
-            stringstream divArrayPath;
-            divArrayPath << iterationPath << "/divArray" << setw(5) << setfill('0') << iter << ".bin";
-            
-            // Cell deaths.
-            int deathArrayDims[2];
-            deathArrayDims[0] = tree->GetNumCells();
-            deathArrayDims[1] = 1;
-            stringstream deathArrayPath;
-            deathArrayPath << iterationPath << "/deathArray" << setw(5) << setfill('0') << iter << ".bin";
-            
-            // Iterations when the cells were created.
-            double *iterArray = new double[tMax*tree->GetNumCells()];
-            tree->GetIterations(iterArray);
-            int iterArrayDims[2];
-            iterArrayDims[0] = tMax;
-            iterArrayDims[1] = tree->GetNumCells();
-            stringstream iterArrayPath;
-            iterArrayPath << iterationPath << "/iterationArray" << setw(5) << setfill('0') << iter << ".bin";
-            
-            ArraySave::Save<double>(2, cellArrayDims, cellArray, cellArrayPath.str().c_str());
-            ArraySave::Save<double>(2, divArrayDims, divArray, divArrayPath.str().c_str());
-            ArraySave::Save<double>(2, deathArrayDims, deathArray, deathArrayPath.str().c_str());
-            ArraySave::Save<double>(2, iterArrayDims, iterArray, iterArrayPath.str().c_str());
-            
-            delete[] cellArray;
-            delete[] divArray;
-            delete[] deathArray;
-            delete[] iterArray;
-        }
-
-		iter++;
-	}
-
-	tree->Print();
-    lout << endl;  // Empty line after all outputs.
+	// Writes the remaining printouts.
+	lout.SetAsync(false);
+
+	if (!linker.GetError().empty()) {
+		if (saveLogFile) {
+			lout.CloseFile();
+		}
+		mexErrMsgTxt(linker.GetError().c_str());
+	}
 
 	// Output.
-	plhs[0] = mxCreateDoubleMatrix(tMax, tree->GetNumCells(), mxREAL);
-	plhs[1] = mxCreateDoubleMatrix(tree->GetNumCells(), 2, mxREAL);
-    plhs[2] = mxCreateDoubleMatrix(tree->GetNumCells(), 1, mxREAL);
-	double *cellA = mxGetPr(plhs[0]);
-	double *divA = mxGetPr(plhs[1]);
-    double *deathA = mxGetPr(plhs[2]);
-	tree->GetCells(cellA, divA, deathA);
+	plhs[0] = mxCreateDoubleMatrix(tMax, linker.GetNumCells(), mxREAL);
+	plhs[1] = mxCreateDoubleMatrix(linker.GetNumCells(), 2, mxREAL);
+    plhs[2] = mxCreateDoubleMatrix(linker.GetNumCells(), 1, mxREAL);
+	linker.GetCells(mxGetPr(plhs[0]), mxGetPr(plhs[1]), mxGetPr(plhs[2]));
+	if (nlhs > 3) {
+		plhs[3] = TraceMatrix(linker);
+	}
 
     if (saveLogFile) {
         lout.CloseFile();
     }
 
 	return;
-}
\ No newline at end of file
+}
+
+#else
+
+// Gets the dimensions of a matrix that has been opened from a binary file saved by
+// ArraySave::Save<double>, or by the corresponding Matlab code. The elements are not copied, so
+// aView has to be kept until the matrix is no longer used. Returns false if the file could not be
+// read or if the array has more than 2 dimensions.
+static bool MatrixSize(const ArrayView &aView, int &aNumRows, int &aNumCols) {
+	const vector<int> &dims = aView.GetDims();
+	if (!aView.IsOpen() || dims.empty() || dims.size() > 2) {
+		return false;
+	}
+	aNumRows = dims[0];
+	aNumCols = (dims.size() == 2) ? dims[1] : 1;
+	return (int) aView.GetLength() == aNumRows * aNumCols;
+}
+
+// Prints how the program is used.
+static void PrintUsage() {
+	cerr << "Usage: ViterbiTrackLinking <input folder> <output folder> [-option value]..." << endl
+		<< endl
+		<< "The input folder must contain the binary files numDets.bin, countScores.bin," << endl
+		<< "migrationScores.bin, splitScores.bin, deathScores.bin, appearanceScores.bin and" << endl
+		<< "disappearanceScores.bin, with the same matrices as the first 7 inputs of the" << endl
+		<< "mex-file. The files start with an int32 with the number of dimensions, followed" << endl
+		<< "by one int32 per dimension and the elements as column-major doubles. The tracks" << endl
+		<< "are written to cellArray.bin, divArray.bin and deathArray.bin in the output" << endl
+		<< "folder, and the trace of the iterations is written to trace.bin." << endl
+		<< endl
+		<< "Options:" << endl
+		<< "-singleIdleState, -maxMigScore, -numThreads, -windowed, -batchSize, -lazySwaps," << endl
+		<< "-onlineWindow, -onlineHorizon, -decompose, -minScore, -maxIterations and" << endl
+		<< "-timeBudget, -verbosity and -asyncLog take numbers and have the same meaning as" << endl
+		<< "the corresponding inputs of the mex-file. -iterationFolder and -logFile take" << endl
+		<< "paths. -initialFolder takes an output folder of a previous run, which the track" << endl
+		<< "linking starts from." << endl;
+}
+
+// Standalone executable that links tracks without Matlab. The input and output matrices are stored
+// in binary files. The program can be compiled by compiling all source files in this folder without
+// defining MATLAB, for example using g++ -O2 -std=c++11 -pthread *.cpp -o ViterbiTrackLinking.
+int main(int argc, char *argv[]) {
+	if (argc < 3 || argc % 2 == 0) {
+		PrintUsage();
+		return 1;
+	}
+	string inputFolder = argv[1];
+	string outputFolder = argv[2];
+
+	// Map the score matrices. The linker reads the scores directly from the mapped files, so the
+	// views are kept until the linking is done.
+	const char *inputNames[] = {"numDets", "countScores", "migrationScores", "splitScores",
+		"deathScores", "appearanceScores", "disappearanceScores"};
+	ArrayView numDetsView(inputFolder + "/numDets.bin");
+	ArrayView countView(inputFolder + "/countScores.bin");
+	ArrayView migView(inputFolder + "/migrationScores.bin");
+	ArrayView mitView(inputFolder + "/splitScores.bin");
+	ArrayView apoView(inputFolder + "/deathScores.bin");
+	ArrayView appearView(inputFolder + "/appearanceScores.bin");
+	ArrayView disappearView(inputFolder + "/disappearanceScores.bin");
+	const ArrayView *views[] = {&numDetsView, &countView, &migView, &mitView, &apoView, &appearView,
+		&disappearView};
+	int numRows[7];
+	int numCols[7];
+	for (int i=0; i<7; i++) {
+		if (!MatrixSize(*views[i], numRows[i], numCols[i])) {
+			cerr << "Unable to read the matrix in " << inputFolder << "/" << inputNames[i] << ".bin." << endl;
+			return 1;
+		}
+	}
+
+	// Read the options.
+	bool singleIdleState = false;
+	double maxMigScore = 0;
+	string logFilePath;
+	string initialFolder;
+	vector<pair<string, string> > options;
+	for (int i=3; i<argc; i+=2) {
+		string name = argv[i];
+		if (name == "-singleIdleState") {
+			singleIdleState = (atof(argv[i+1]) != 0);
+		} else if (name == "-maxMigScore") {
+			maxMigScore = atof(argv[i+1]);
+		} else if (name == "-logFile") {
+			logFilePath = argv[i+1];
+		} else if (name == "-initialFolder") {
+			initialFolder = argv[i+1];
+		} else {
+			options.push_back(make_pair(name, string(argv[i+1])));
+		}
+	}
+
+	int tMax = numRows[0] * numCols[0];
+	int maxCount = numCols[1] - 3;
+	ScoreMatrix count(countView.GetData(), numRows[1], numCols[1]);
+	ScoreMatrix mig(migView.GetData(), numRows[2], numCols[2]);
+	ScoreMatrix mit(mitView.GetData(), numRows[3], numCols[3]);
+	ScoreMatrix apo(apoView.GetData(), numRows[4], numCols[4]);
+	ScoreMatrix appear(appearView.GetData(), numRows[5], numCols[5]);
+	ScoreMatrix disappear(disappearView.GetData(), numRows[6], numCols[6]);
+	TrackLinker linker(singleIdleState, tMax, maxCount, numDetsView.GetData(), count, mig, mit, apo, appear,
+		disappear, maxMigScore);
+
+	int onlineWindow = 0;
+	int onlineHorizon = 0;
+	bool asyncLog = false;
+	for (int i=0; i<(int)options.size(); i++) {
+		string name = options[i].first;
+		double value = atof(options[i].second.c_str());
+		if (name == "-iterationFolder") {
+			linker.SetIterationPath(options[i].second);
+		} else if (name == "-numThreads") {
+			linker.SetNumThreads((int) value);
+		} else if (name == "-windowed") {
+			linker.SetWindowed(value != 0);
+		} else if (name == "-batchSize") {
+			linker.SetBatchSize((int) value);
+		} else if (name == "-lazySwaps") {
+			linker.SetLazySwaps(value != 0);
+		} else if (name == "-onlineWindow") {
+			onlineWindow = (int) value;
+		} else if (name == "-onlineHorizon") {
+			onlineHorizon = (int) value;
+		} else if (name == "-decompose") {
+			linker.SetDecompose(value != 0);
+		} else if (name == "-minScore") {
+			linker.SetMinScore(value);
+		} else if (name == "-maxIterations") {
+			linker.SetMaxIterations((int) value);
+		} else if (name == "-timeBudget") {
+			linker.SetTimeBudget(value);
+		} else if (name == "-verbosity") {
+			lout.SetVerbosity((int) value);
+		} else if (name == "-asyncLog") {
+			asyncLog = (value != 0);
+		} else {
+			cerr << "Unknown option " << name << "." << endl << endl;
+			PrintUsage();
+			return 1;
+		}
+	}
+	linker.SetOnline(onlineWindow, onlineHorizon);
+
+	// Map a previous result. Empty paths give views that are not open.
+	ArrayView initCellView(initialFolder.empty() ? string() : initialFolder + "/cellArray.bin");
+	ArrayView initDivView(initialFolder.empty() ? string() : initialFolder + "/divArray.bin");
+	ArrayView initDeathView(initialFolder.empty() ? string() : initialFolder + "/deathArray.bin");
+	if (!initialFolder.empty()) {
+		int cellRows, cellCols, divRows, divCols, deathRows, deathCols;
+		if (!MatrixSize(initCellView, cellRows, cellCols)
+			|| !MatrixSize(initDivView, divRows, divCols)
+			|| !MatrixSize(initDeathView, deathRows, deathCols)) {
+			cerr << "Unable to read the previous result in " << initialFolder << "." << endl;
+			return 1;
+		}
+		if (cellRows != tMax || divRows * divCols != 2 * cellCols || deathRows * deathCols != cellCols) {
+			cerr << "The matrices of the previous result do not match the score matrices." << endl;
+			return 1;
+		}
+		linker.SetWarmStart(cellCols, initCellView.GetData(), initDivView.GetData(), initDeathView.GetData());
+	}
+
+	string settingsError = linker.CheckSettings();
+	if (!settingsError.empty()) {
+		cerr << settingsError << "." << endl;
+		return 1;
+	}
+
+	if (!logFilePath.empty()) {
+		lout.OpenFile(logFilePath);
+	}
+	lout.SetAsync(asyncLog);
+
+	linker.Link();
+	lout.SetAsync(false);
+
+	if (!linker.GetError().empty()) {
+		cerr << linker.GetError() << "." << endl;
+		if (!logFilePath.empty()) {
+			lout.CloseFile();
+		}
+		return 1;
+	}
+
+	// Write the outputs.
+	int numCells = linker.GetNumCells();
+	vector<double> cellA(max(tMax*numCells, 1));
+	vector<double> divA(max(2*numCells, 1));
+	vector<double> deathA(max(numCells, 1));
+	linker.GetCells(&cellA[0], &divA[0], &deathA[0]);
+	int cellDims[2] = {tMax, numCells};
+	int divDims[2] = {numCells, 2};
+	int deathDims[2] = {numCells, 1};
+	int traceDims[2] = {linker.GetNumTraceRows(), TrackLinker::NUM_TRACE_COLUMNS};
+	vector<double> traceA(max(traceDims[0] * traceDims[1], 1));
+	for (int i=0; i<traceDims[0]; i++) {
+		for (int j=0; j<traceDims[1]; j++) {
+			traceA[j*traceDims[0]+i] = linker.GetTrace()[i*traceDims[1]+j];
+		}
+	}
+	ArraySave::Save<double>(2, cellDims, &cellA[0], (outputFolder + "/cellArray.bin").c_str());
+	ArraySave::Save<double>(2, divDims, &divA[0], (outputFolder + "/divArray.bin").c_str());
+	ArraySave::Save<double>(2, deathDims, &deathA[0], (outputFolder + "/deathArray.bin").c_str());
+	ArraySave::Save<double>(2, traceDims, &traceA[0], (outputFolder + "/trace.bin").c_str());
+
+	if (!logFilePath.empty()) {
+		lout.CloseFile();
+	}
+	return 0;
+}
+
+#endif
@@ -5,7 +5,8 @@ function oOrder = MinSquareDist(aStart, aGoal)
 % minimizes the sum of the squared distances between matched points. The
 % sets of point can have coordinate vectors of arbitrary length, and they
 % can have different numbers of points. The matching is done using the
-% Hungarian algorithm. Dummy nodes are introduced if the sets have
+% Hungarian algorithm, using the sparse solver SparseHungarian if it has
+% been compiled. Dummy nodes are introduced if the sets have
 % different numbers of points, but the function still minimizes the sum of
 % squared distances between matched points. All points in the set with
 % fewest points will be matched.
@@ -23,7 +24,7 @@ function oOrder = MinSquareDist(aStart, aGoal)
 %          set.
 %
 % See also:
-% Hungarian
+% Hungarian, SparseHungarian
 
 m = size(aStart,1);
 n = size(aGoal,1);
@@ -47,5 +48,10 @@ elseif n > m
 end
 
 % Solve assignment problem.
-oOrder = Hungarian(dist);
+if exist('SparseHungarian', 'file') == 3
+    [rows, cols] = find(true(size(dist)));
+    oOrder = SparseHungarian(rows, cols, dist(:));
+else
+    oOrder = Hungarian(dist);
+end
 end
\ No newline at end of file